@@ -0,0 +1,97 @@
+#include "include/batch_runner.h"
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Пакетный прогон арен для исследования баланса методом Монте-Карло.
+//   --runs N        число случайных расстановок (по умолчанию 1000)
+//   --npcs N        NPC в каждой расстановке (по умолчанию 200)
+//   --ranges a,b,c  дальности боёв (по умолчанию 10,50,100)
+//   --threads N     число потоков (по умолчанию - число ядер)
+//   --seed N        начальное зерно генератора
+//   --scaling       замер ускорения для 1..N потоков
+//   файлы...        вместо случайных расстановок - NPC из файлов
+
+namespace {
+
+std::vector<double> parseRanges(const std::string& text) {
+    std::vector<double> ranges;
+    std::istringstream iss(text);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        ranges.push_back(std::stod(item));
+    }
+    return ranges;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t runs = 1000;
+    size_t npcs = 200;
+    size_t threads = std::thread::hardware_concurrency();
+    unsigned seed = 1;
+    bool scaling = false;
+    std::vector<double> ranges = {10.0, 50.0, 100.0};
+    std::vector<std::string> files;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument("Missing value for " + arg);
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--runs") {
+                runs = std::stoul(value());
+            } else if (arg == "--npcs") {
+                npcs = std::stoul(value());
+            } else if (arg == "--ranges") {
+                ranges = parseRanges(value());
+            } else if (arg == "--threads") {
+                threads = std::stoul(value());
+            } else if (arg == "--seed") {
+                seed = static_cast<unsigned>(std::stoul(value()));
+            } else if (arg == "--scaling") {
+                scaling = true;
+            } else {
+                files.push_back(arg);
+            }
+        }
+
+        std::vector<BatchJob> jobs;
+        if (files.empty()) {
+            jobs = BatchRunner::generateJobs(runs, npcs, ranges, seed);
+        } else {
+            for (const auto& file : files) {
+                BatchJob job;
+                job.sourceFile = file;
+                job.ranges = ranges;
+                jobs.push_back(job);
+            }
+        }
+
+        if (scaling) {
+            double baseline = 0.0;
+            for (size_t count = 1; count <= std::max<size_t>(threads, 1); count *= 2) {
+                BatchSummary summary = BatchRunner(count).run(jobs);
+                if (count == 1) baseline = summary.elapsedMs;
+                std::cout << "threads " << count << ": " << summary.elapsedMs << " ms, speedup "
+                          << baseline / summary.elapsedMs << "\n";
+            }
+            return 0;
+        }
+
+        BatchRunner(threads).run(jobs).print(std::cout);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include "../include/arena.h"
+#include "../include/factory.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+// Загрузка файлов с долей некорректных строк 0%, 10% и 50%:
+// прежний путь на исключениях против Arena::loadFromFile без исключений
+// Запуск: ./Laboratory_6_bench_bad_lines [число строк]
+
+namespace {
+
+void writeFile(const std::string& filename, size_t count, double badShare, unsigned seed) {
+    static const char* kTypes[] = {"Dragon", "Elf", "Druid"};
+    static const char* kBad[] = {"Orc Grom 1 1", "Dragon NoCoords", "Elf Far 900 900", "garbage"};
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> coord(0, 500);
+    std::uniform_real_distribution<double> share(0.0, 1.0);
+    std::ofstream out(filename);
+    for (size_t i = 0; i < count; ++i) {
+        if (share(rng) < badShare) {
+            out << kBad[i % 4] << "\n";
+        } else {
+            out << kTypes[i % 3] << " Npc" << i << " " << coord(rng) << " " << coord(rng) << "\n";
+        }
+    }
+}
+
+// Прежняя реализация: исключение на каждую некорректную строку
+size_t loadWithExceptions(Arena& arena, const std::string& filename) {
+    std::ifstream file(filename);
+    std::string line;
+    size_t loaded = 0;
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        try {
+            arena.addNpc(NpcFactory::createFromString(line));
+            loaded++;
+        } catch (const std::exception&) {
+        }
+    }
+    return loaded;
+}
+
+template <typename Func>
+double measureMs(Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 200000;
+    const std::string filename = "bench_bad_lines.txt";
+
+    for (double badShare : {0.0, 0.1, 0.5}) {
+        writeFile(filename, count, badShare, 42);
+
+        size_t oldLoaded = 0;
+        double oldMs = measureMs([&] {
+            Arena arena;
+            oldLoaded = loadWithExceptions(arena, filename);
+        });
+
+        size_t newLoaded = 0;
+        double newMs = measureMs([&] {
+            Arena arena;
+            newLoaded = arena.loadFromFile(filename).loaded;
+        });
+
+        std::cout << static_cast<int>(badShare * 100) << "% bad lines: "
+                  << "exceptions " << oldMs << " ms, "
+                  << "error codes " << newMs << " ms, "
+                  << "speedup " << oldMs / newMs << "x "
+                  << "(loaded " << oldLoaded << "/" << newLoaded << ")\n";
+    }
+
+    std::remove(filename.c_str());
+    return 0;
+}
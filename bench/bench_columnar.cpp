@@ -0,0 +1,84 @@
+#include "../include/columnar_format.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+
+// Степень сжатия и скорость декодирования поколоночного формата
+// в сравнении с текстовым форматом Arena::saveToFile
+// Запуск: ./Laboratory_6_bench_columnar [число NPC]
+
+namespace {
+
+size_t fileSize(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    return static_cast<size_t>(in.tellg());
+}
+
+template <typename Func>
+double measureMs(Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 200000;
+    static const char* kTypes[] = {"Dragon", "Elf", "Druid"};
+
+    Arena arena;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> coord(0, 500);
+    for (size_t i = 0; i < count; ++i) {
+        arena.createAndAddNpc(kTypes[rng() % 3], "Npc" + std::to_string(i), coord(rng), coord(rng));
+    }
+
+    const std::string textFile = "bench_npcs.txt";
+    const std::string columnarFile = "bench_npcs.bin";
+    arena.saveToFile(textFile);
+    ColumnarFormat::save(arena, columnarFile);
+
+    size_t textBytes = fileSize(textFile);
+    size_t columnarBytes = fileSize(columnarFile);
+    std::cout << "NPCs: " << count << "\n"
+              << "text:     " << textBytes << " bytes\n"
+              << "columnar: " << columnarBytes << " bytes\n"
+              << "ratio:    " << static_cast<double>(textBytes) / columnarBytes << "x\n";
+
+    double textMs = measureMs([&] {
+        Arena loaded;
+        loaded.loadFromFile(textFile);
+    });
+    std::cout << "text load:             " << textMs << " ms, "
+              << count / textMs * 1000.0 << " NPC/s\n";
+
+    // Чистое декодирование без вставки в арену
+    std::vector<char> block;
+    std::vector<ColumnarNpc> decoded;
+    double decodeMs = measureMs([&] {
+        ColumnarReader reader(columnarFile);
+        while (reader.readBlock(block)) {
+            reader.decodeBlock(block, decoded);
+        }
+    });
+    std::cout << "columnar decode only:  " << decodeMs << " ms, "
+              << count / decodeMs * 1000.0 << " NPC/s, "
+              << columnarBytes / decodeMs / 1000.0 << " MB/s\n";
+
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads <= hardware; threads *= 2) {
+        double loadMs = measureMs([&] {
+            Arena loaded;
+            ColumnarFormat::load(loaded, columnarFile, threads);
+        });
+        std::cout << "columnar load, " << threads << " threads: " << loadMs << " ms, "
+                  << count / loadMs * 1000.0 << " NPC/s\n";
+    }
+
+    std::remove(textFile.c_str());
+    std::remove(columnarFile.c_str());
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "../include/arena.h"
+#include "../include/compact_arena.h"
+#include <iomanip>
+#include <iostream>
+#include <malloc.h>
+#include <random>
+#include <string>
+
+// Память на NPC: обычная арена (объекты иерархии + std::map) против
+// CompactArena (8-байтовые записи + таблица имён). Память измеряется
+// по счётчику занятых блоков malloc (mallinfo2).
+// Запуск: ./Laboratory_6_bench_compact [count]
+
+namespace {
+
+size_t heapInUse() {
+    return mallinfo2().uordblks;
+}
+
+void report(const std::string& label, size_t bytes, size_t count) {
+    double perNpc = static_cast<double>(bytes) / count;
+    std::cout << "  " << std::setw(14) << std::left << label << std::right
+              << std::setw(8) << std::fixed << std::setprecision(1) << perNpc << " bytes/NPC"
+              << std::setw(14) << std::setprecision(0) << (1024.0 * 1024 * 1024) / perNpc
+              << " NPCs per GiB\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    static const char* kTypes[] = {"Dragon", "Elf", "Druid"};
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> coord(0, 500);
+
+    // Одинаковые имена для обеих арен; строки генерируются заранее
+    std::vector<std::string> names;
+    std::vector<std::pair<int, int>> positions;
+    names.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        names.push_back("Npc" + std::to_string(i));
+        positions.push_back({coord(rng), coord(rng)});
+    }
+    std::cout << "NPCs: " << count << " (names like \"" << names.back() << "\")\n";
+
+    {
+        size_t before = heapInUse();
+        Arena arena;
+        for (size_t i = 0; i < count; ++i) {
+            arena.createAndAddNpc(kTypes[i % 3], names[i], positions[i].first, positions[i].second);
+        }
+        report("Arena", heapInUse() - before, count);
+    }
+
+    {
+        size_t before = heapInUse();
+        CompactArena arena;
+        for (size_t i = 0; i < count; ++i) {
+            arena.tryAddNpc(kTypes[i % 3], names[i], positions[i].first, positions[i].second);
+        }
+        report("CompactArena", heapInUse() - before, count);
+        std::cout << "  (self-reported: " << arena.bytesUsed() / count << " bytes/NPC, of which "
+                  << sizeof(CompactNpc) << " record)\n";
+    }
+    return 0;
+}
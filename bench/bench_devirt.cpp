@@ -0,0 +1,115 @@
+#include "../include/combat_visitor.h"
+#include "../include/factory.h"
+#include "../include/npc_record.h"
+#include "../include/npc_registry.h"
+#include "../include/dragon.h"
+#include "../include/elf.h"
+#include "../include/druid.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Виртуальная иерархия Npc против записей NpcRecord с тегом вида:
+// обход посетителем и полный перебор пар боя
+// Запуск: ./Laboratory_6_bench_devirt [count]
+
+namespace {
+
+class VirtualCounter : public Visitor {
+    public:
+        long long sum = 0;
+
+        void visit(Dragon& npc) override { sum += npc.getX(); }
+        void visit(Elf& npc) override { sum += npc.getY(); }
+        void visit(Druid& npc) override { sum += npc.getX() + npc.getY(); }
+};
+
+class RecordCounter : public RecordVisitor<RecordCounter> {
+    public:
+        long long sum = 0;
+
+        void visitDragon(NpcRecord& record) { sum += record.x; }
+        void visitElf(NpcRecord& record) { sum += record.y; }
+        void visitDruid(NpcRecord& record) { sum += record.x + record.y; }
+};
+
+template <typename Body>
+void report(const std::string& label, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    long long check = body();
+    auto finish = std::chrono::steady_clock::now();
+    std::cout << "  " << std::setw(30) << std::left << label << std::right
+              << std::setw(10) << std::fixed << std::setprecision(2)
+              << std::chrono::duration<double, std::milli>(finish - start).count() << " ms"
+              << "  (check " << check << ")\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 5000;
+    static const char* kTypes[] = {"Dragon", "Elf", "Druid"};
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> coord(0, 500);
+    std::uniform_int_distribution<int> kind(0, 2);
+
+    std::vector<std::unique_ptr<Npc>> npcs;
+    for (std::size_t i = 0; i < count; ++i) {
+        npcs.push_back(NpcFactory::createNpc(kTypes[kind(rng)], "Npc" + std::to_string(i),
+                                             coord(rng), coord(rng)));
+    }
+    std::vector<NpcRecord> records = toRecords(npcs);
+    const double range = 50.0;
+    const int iterations = 200;
+
+    std::cout << "NPCs: " << count << ", sizeof(NpcRecord) = " << sizeof(NpcRecord)
+              << ", sizeof(Dragon) = " << sizeof(Dragon) << "\n";
+
+    std::cout << "Visitor pass x" << iterations << "\n";
+    report("virtual accept + visit", [&] {
+        VirtualCounter visitor;
+        for (int i = 0; i < iterations; ++i) {
+            for (auto& npc : npcs) {
+                npc->accept(visitor);
+            }
+        }
+        return visitor.sum;
+    });
+    report("record tag switch", [&] {
+        RecordCounter visitor;
+        for (int i = 0; i < iterations; ++i) {
+            visitor.visit(records);
+        }
+        return visitor.sum;
+    });
+
+    std::cout << "Battle evaluation, all pairs, range " << range << "\n";
+    report("hierarchy + CombatVisitor", [&] {
+        CombatVisitor visitor;
+        long long kills = 0;
+        for (std::size_t i = 0; i < npcs.size(); ++i) {
+            for (std::size_t j = i + 1; j < npcs.size(); ++j) {
+                if (npcs[i]->distanceTo(*npcs[j]) > range) continue;
+                kills += visitor.canKill(npcs[i].get(), npcs[j].get());
+                kills += visitor.canKill(npcs[j].get(), npcs[i].get());
+            }
+        }
+        return kills;
+    });
+    report("records + outcome table", [&] {
+        const NpcRegistry& registry = NpcRegistry::instance();
+        long long kills = 0;
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            for (std::size_t j = i + 1; j < records.size(); ++j) {
+                if (records[i].distanceTo(records[j]) > range) continue;
+                auto bits = static_cast<unsigned>(registry.outcome(records[i].kind, records[j].kind));
+                kills += (bits & 1) + (bits >> 1);
+            }
+        }
+        return kills;
+    });
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include "../include/arena.h"
+#include "../include/factory.h"
+#include "../include/npc_writer.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Выгрузка большого числа NPC в текст: поток с std::endl на каждую запись
+// (прежний saveToFile) и буферизованный NpcTextWriter. Результат - NPC/с.
+// Запуск: ./Laboratory_6_bench_export [count]
+
+namespace {
+
+const char* kFile = "bench_export.txt";
+
+std::vector<std::unique_ptr<Npc>> makeNpcs(std::size_t count) {
+    static const char* kTypes[] = {"Dragon", "Elf", "Druid"};
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> coord(0, 500);
+    std::vector<std::unique_ptr<Npc>> npcs;
+    npcs.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        npcs.push_back(NpcFactory::createNpc(kTypes[i % 3], "Npc" + std::to_string(i),
+                                             coord(rng), coord(rng)));
+    }
+    return npcs;
+}
+
+template <typename Body>
+void report(const std::string& label, std::size_t count, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto finish = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(finish - start).count();
+    std::cout << "  " << std::setw(26) << std::left << label << std::right
+              << std::setw(10) << std::fixed << std::setprecision(1) << seconds * 1000.0 << " ms"
+              << std::setw(14) << std::setprecision(0) << count / seconds << " NPC/s\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    auto npcs = makeNpcs(count);
+    std::cout << "NPCs: " << count << "\n";
+
+    report("ofstream + std::endl", count, [&] {
+        std::ofstream file(kFile);
+        for (const auto& npc : npcs) {
+            file << npc->getType() << " " << npc->getName() << " "
+                 << npc->getX() << " " << npc->getY() << std::endl;
+        }
+    });
+
+    report("ofstream + '\\n'", count, [&] {
+        std::ofstream file(kFile);
+        for (const auto& npc : npcs) {
+            file << npc->getType() << ' ' << npc->getName() << ' '
+                 << npc->getX() << ' ' << npc->getY() << '\n';
+        }
+    });
+
+    report("NpcTextWriter -> fd", count, [&] {
+        FileSink file(kFile);
+        NpcTextWriter writer(file);
+        for (const auto& npc : npcs) {
+            writer.writeRecord(*npc);
+        }
+        writer.flush();
+        file.close();
+    });
+
+    report("operator<< info lines", count, [&] {
+        std::ofstream file(kFile);
+        for (const auto& npc : npcs) {
+            file << "  " << *npc << std::endl;
+        }
+    });
+
+    report("NpcTextWriter info lines", count, [&] {
+        FileSink file(kFile);
+        NpcTextWriter writer(file);
+        for (const auto& npc : npcs) {
+            writer.append("  ");
+            writer.writeInfo(*npc);
+            writer.append('\n');
+        }
+        writer.flush();
+        file.close();
+    });
+
+    std::remove(kFile);
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "../include/spatial_index.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Поиск пар для боя в подземелье, где преобладает один вид:
+// общий индекс, общий индекс с отбором по видам и индексы по видам
+// Запуск: ./Laboratory_6_bench_kind_join
+
+namespace {
+
+// dominantShare - доля драконов, остальные поровну эльфы и друиды
+std::vector<SpatialPoint> dungeon(std::size_t count, double dominantShare, bool clustered,
+                                  unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> coord(0, 500);
+    std::uniform_real_distribution<double> share(0.0, 1.0);
+    std::normal_distribution<double> spread(0.0, 10.0);
+    std::vector<std::pair<int, int>> rooms;
+    for (int i = 0; i < 6; ++i) {
+        rooms.push_back({coord(rng), coord(rng)});
+    }
+
+    std::vector<SpatialPoint> points;
+    points.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        int x = coord(rng);
+        int y = coord(rng);
+        if (clustered) {
+            const auto& room = rooms[i % rooms.size()];
+            x = std::clamp(room.first + static_cast<int>(spread(rng)), 0, 500);
+            y = std::clamp(room.second + static_cast<int>(spread(rng)), 0, 500);
+        }
+        double roll = share(rng);
+        std::uint8_t kind = roll < dominantShare ? 0
+                          : (roll < dominantShare + (1.0 - dominantShare) / 2 ? 1 : 2);
+        points.push_back({x, y, i, kind});
+    }
+    return points;
+}
+
+KindPairFilter variantRules() {
+    KindPairFilter filter;
+    filter.allowed[0][1] = true;  // Dragon -> Elf
+    filter.allowed[1][2] = true;  // Elf -> Druid
+    filter.allowed[2][0] = true;  // Druid -> Dragon
+    return filter;
+}
+
+template <typename Search>
+void report(const std::string& label, Search search) {
+    std::vector<CandidatePair> pairs;
+    auto start = std::chrono::steady_clock::now();
+    PairSearchInfo info = search(pairs);
+    auto finish = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(finish - start).count();
+    std::cout << "  " << std::setw(22) << std::left << label << std::right
+              << std::setw(10) << std::fixed << std::setprecision(2) << ms << " ms"
+              << "  checks: " << std::setw(10) << info.distanceChecks
+              << "  pairs: " << pairs.size() << "\n";
+}
+
+void runCase(std::size_t count, double dominantShare, bool clustered, double range) {
+    auto points = dungeon(count, dominantShare, clustered, 7);
+    KindPairFilter filter = variantRules();
+    SpatialBackend backend = chooseSpatialBackend(points, range);
+
+    std::cout << (clustered ? "clustered" : "uniform") << ", n=" << count
+              << ", dragons=" << static_cast<int>(dominantShare * 100) << "%"
+              << ", range=" << range << " (" << spatialBackendName(backend) << ")\n";
+
+    report("single index", [&](std::vector<CandidatePair>& out) {
+        return collectPairsWithin(backend, points, range, out);
+    });
+    report("single + kind filter", [&](std::vector<CandidatePair>& out) {
+        return collectPairsWithin(backend, points, range, out, &filter);
+    });
+    report("per-kind indices", [&](std::vector<CandidatePair>& out) {
+        KindPartitionedIndex index;
+        index.build(backend, points, range);
+        return index.collectPairsWithin(range, filter, out);
+    });
+}
+
+}
+
+int main() {
+    for (double share : {0.34, 0.8, 0.95}) {
+        runCase(50000, share, false, 5.0);
+        runCase(50000, share, true, 2.0);
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include "../include/arena.h"
+#include "../include/npc_writer.h"
+#include "../include/perf_counters.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+// Хранение по имени против хранения по ключу Мортона: бой и сохранение.
+// Промахи кэша снимаются счётчиком perf (PerfCounters);
+// если счётчик недоступен (контейнер, perf_event_paranoid), выводится n/a.
+// Размер сжатого сохранения измеряется утилитой gzip, если она есть.
+// NPC расставлены по арене размера по умолчанию (MAX_WIDTH x MAX_HEIGHT).
+// Запуск: ./Laboratory_6_bench_morton [count]
+
+namespace {
+
+class StringSink : public TextSink {
+    public:
+        std::string text;
+
+        void write(const char* data, std::size_t size) override {
+            text.append(data, size);
+        }
+};
+
+template <typename Body>
+void report(const std::string& label, Body body) {
+    PerfCounters counters;
+    auto start = std::chrono::steady_clock::now();
+    counters.start();
+    body();
+    PhaseCounters counted = counters.stop();
+    auto finish = std::chrono::steady_clock::now();
+    std::cout << "  " << std::setw(24) << std::left << label << std::right
+              << std::setw(10) << std::fixed << std::setprecision(2)
+              << std::chrono::duration<double, std::milli>(finish - start).count() << " ms"
+              << "  cache misses: ";
+    if (counted.has(HardwareCounter::CacheMisses)) {
+        std::cout << counted.get(HardwareCounter::CacheMisses);
+    } else {
+        std::cout << "n/a";
+    }
+    std::cout << "\n";
+}
+
+long long gzipSize(const std::string& filename) {
+    std::string command = "gzip -c " + filename + " 2>/dev/null | wc -c";
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) return -1;
+    long long size = -1;
+    if (fscanf(pipe, "%lld", &size) != 1) size = -1;
+    pclose(pipe);
+    return size;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 200000;
+    static const char* kTypes[] = {"Dragon", "Elf", "Druid"};
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> coord(0, 500);
+
+    // Имена не связаны с расположением: порядок по имени случаен в пространстве
+    std::vector<std::size_t> ids(count);
+    for (std::size_t i = 0; i < count; ++i) ids[i] = i;
+    std::shuffle(ids.begin(), ids.end(), rng);
+
+    std::vector<std::pair<int, int>> positions(count);
+    for (auto& position : positions) {
+        position = {coord(rng), coord(rng)};
+    }
+    std::cout << "NPCs: " << count << "\n";
+
+    for (StorageOrder order : {StorageOrder::Name, StorageOrder::Morton}) {
+        const char* label = order == StorageOrder::Name ? "name" : "morton";
+        std::cout << "Storage order: " << label << "\n";
+
+        Arena arena;
+        arena.setStorageOrder(order);
+        for (std::size_t i = 0; i < count; ++i) {
+            arena.createAndAddNpc(kTypes[i % 3], "Npc" + std::to_string(ids[i]),
+                                  positions[i].first, positions[i].second);
+        }
+
+        report("save to memory", [&] {
+            StringSink sink;
+            arena.writeNpcs(sink);
+        });
+
+        std::string filename = std::string("bench_morton_") + label + ".txt";
+        arena.saveToFile(filename);
+        long long compressed = gzipSize(filename);
+        std::remove(filename.c_str());
+        if (compressed > 0) {
+            std::cout << "  gzip'ed save: " << compressed << " bytes\n";
+        }
+
+        // Перемещение 1% NPC: перемещённые обходятся вместе с отсортированной частью
+        std::mt19937 moveRng(7);
+        for (std::size_t i = 0; i < count / 100; ++i) {
+            arena.moveNpc("Npc" + std::to_string(ids[i]), coord(moveRng), coord(moveRng));
+        }
+        report("save after 1% moves", [&] {
+            StringSink sink;
+            arena.writeNpcs(sink);
+        });
+
+        for (double range : {2.0, 6.0}) {
+            Arena copy = arena.fork();
+            report("battle, range " + std::to_string(static_cast<int>(range)), [&] {
+                copy.startBattle(range);
+            });
+            const BattleStats& stats = copy.getLastBattleStats();
+            std::cout << "    phases ms: candidates " << stats.candidateNs / 1e6
+                      << ", combat " << stats.combatNs / 1e6
+                      << ", dispatch " << stats.dispatchNs / 1e6
+                      << ", removal " << stats.removalNs / 1e6 << "\n";
+        }
+    }
+    return 0;
+}
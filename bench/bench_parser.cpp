@@ -0,0 +1,73 @@
+#include "../include/factory.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Скорость разбора строк NPC: прежний разбор через std::istringstream
+// против NpcFactory::parseLine на std::from_chars
+// Запуск: ./Laboratory_6_bench_parser [число строк]
+
+namespace {
+
+// Прежняя реализация createFromString без создания NPC
+void parseWithStream(const std::string& line, std::string& type, std::string& name, int& x, int& y) {
+    std::istringstream iss(line);
+    iss >> type >> name >> x >> y;
+    if (iss.fail()) {
+        throw std::runtime_error("Failed to parse line: " + line);
+    }
+    if (x < 0 || x > 500 || y < 0 || y > 500) {
+        throw std::out_of_range("Coordinates out of range (0-500): " + line);
+    }
+}
+
+template <typename Func>
+double linesPerSecond(const std::vector<std::string>& lines, Func&& parse) {
+    auto start = std::chrono::steady_clock::now();
+    long long checksum = 0;
+    for (const auto& line : lines) {
+        checksum += parse(line);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (checksum == 42) std::cout << "";
+    return lines.size() / seconds;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    static const char* kTypes[] = {"Dragon", "Elf", "Druid"};
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> coord(0, 500);
+    std::vector<std::string> lines;
+    lines.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        lines.push_back(std::string(kTypes[i % 3]) + " Npc" + std::to_string(i) + " " +
+                        std::to_string(coord(rng)) + " " + std::to_string(coord(rng)));
+    }
+
+    double stream = linesPerSecond(lines, [](const std::string& line) {
+        std::string type, name;
+        int x, y;
+        parseWithStream(line, type, name, x, y);
+        return x + y;
+    });
+
+    double fast = linesPerSecond(lines, [](const std::string& line) {
+        ParsedNpcLine parsed;
+        NpcFactory::parseLine(line, parsed);
+        return parsed.x + parsed.y;
+    });
+
+    std::cout << "lines:        " << count << "\n"
+              << "istringstream: " << stream << " lines/s\n"
+              << "parseLine:     " << fast << " lines/s\n"
+              << "speedup:       " << fast / stream << "x\n";
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include "../include/arena.h"
+#include "../include/trace.h"
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Фазы боя при разном числе NPC: время и аппаратные счётчики каждой фазы.
+// По отношению инструкций к тактам и промахам кэша видно, упирается ли фаза
+// в вычисления или в память. Вывод - массив JSON (BattleStats::writeJson);
+// без доступа к perf счётчики равны null. Если указан файл трассы, в него
+// пишется трасса боёв для chrome://tracing или ui.perfetto.dev.
+// Запуск: ./Laboratory_6_bench_phases [range] [trace.json]
+
+int main(int argc, char** argv) {
+    double range = argc > 1 ? std::atof(argv[1]) : 5.0;
+    const char* const types[] = {"Dragon", "Elf", "Druid"};
+    if (argc > 2) {
+        Tracer::instance().start();
+    }
+
+    std::cout << "[\n";
+    bool first = true;
+    for (size_t count : std::vector<size_t>{1000, 10000, 100000}) {
+        Arena arena;
+        arena.setHardwareCountersEnabled(true);
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> coord(0, MAX_WIDTH);
+        for (size_t i = 0; i < count; ++i) {
+            arena.createAndAddNpc(types[i % 3], "Npc" + std::to_string(i), coord(rng), coord(rng));
+        }
+        arena.startBattle(range);
+
+        if (!first) std::cout << ",\n";
+        first = false;
+        std::cout << "{\"npcs\":" << count << ",\"stats\":";
+        arena.getLastBattleStats().writeJson(std::cout);
+        std::cout << "}";
+    }
+    std::cout << "\n]\n";
+
+    if (argc > 2) {
+        Tracer::instance().stop();
+        Tracer::instance().saveJson(argv[2]);
+    }
+    return 0;
+}
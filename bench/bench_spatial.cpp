@@ -0,0 +1,80 @@
+#include "../include/spatial_index.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Сравнение способов перебора пар на равномерных и кластеризованных данных
+// Запуск: ./Laboratory_6_bench_spatial
+
+namespace {
+
+std::vector<SpatialPoint> uniformPoints(std::size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> coord(0, 500);
+    std::vector<SpatialPoint> points;
+    points.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        points.push_back({coord(rng), coord(rng), i});
+    }
+    return points;
+}
+
+// Комнаты босса с тысячами NPC и пустые коридоры между ними
+std::vector<SpatialPoint> clusteredPoints(std::size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> center(30, 470);
+    std::normal_distribution<double> spread(0.0, 8.0);
+    std::vector<std::pair<int, int>> rooms;
+    for (int i = 0; i < 6; ++i) {
+        rooms.push_back({center(rng), center(rng)});
+    }
+    std::vector<SpatialPoint> points;
+    points.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& room = rooms[i % rooms.size()];
+        int x = std::clamp(room.first + static_cast<int>(spread(rng)), 0, 500);
+        int y = std::clamp(room.second + static_cast<int>(spread(rng)), 0, 500);
+        points.push_back({x, y, i});
+    }
+    return points;
+}
+
+double measureMs(SpatialBackend backend, const std::vector<SpatialPoint>& points,
+                 double range, std::size_t& pairCount) {
+    std::vector<CandidatePair> pairs;
+    auto start = std::chrono::steady_clock::now();
+    collectPairsWithin(backend, points, range, pairs);
+    auto finish = std::chrono::steady_clock::now();
+    pairCount = pairs.size();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+void runCase(const std::string& label, const std::vector<SpatialPoint>& points, double range) {
+    std::cout << label << ", n=" << points.size() << ", range=" << range
+              << " (auto: " << spatialBackendName(chooseSpatialBackend(points, range)) << ")\n";
+
+    for (auto backend : {SpatialBackend::BruteForce, SpatialBackend::UniformGrid,
+                         SpatialBackend::KdTree, SpatialBackend::Auto}) {
+        if (backend == SpatialBackend::BruteForce && points.size() > 20000) {
+            continue;
+        }
+        std::size_t pairCount = 0;
+        double ms = measureMs(backend, points, range, pairCount);
+        std::cout << "  " << std::setw(12) << spatialBackendName(backend)
+                  << std::setw(12) << std::fixed << std::setprecision(2) << ms << " ms"
+                  << "  pairs: " << pairCount << "\n";
+    }
+}
+
+}
+
+int main() {
+    for (std::size_t count : {2000u, 10000u, 50000u}) {
+        runCase("uniform", uniformPoints(count, 42), 5.0);
+        runCase("clustered", clusteredPoints(count, 42), 2.0);
+    }
+    return 0;
+}
@@ -2,13 +2,29 @@
 #include <string>
 #include "npc.h"
 #include <map>
+#include <set>
+#include <unordered_set>
 #include <memory>
 #include "observer.h"
+#include "spatial_index.h"
+#include "battle_stats.h"
+#include "diagnostics.h"
+#include "arena_results.h"
+#include "async_task.h"
+#include <cstdint>
 #include <vector>
 
 #define MAX_WIDTH 500
 #define MAX_HEIGHT 500
 
+class TextSink;
+
+// Порядок хранения NPC, в котором идут снимки боя и сохранения
+enum class StorageOrder {
+    Name,   // по имени (как в карте)
+    Morton  // по ключу Мортона координат: соседние на карте NPC рядом в памяти
+};
+
 
 class Arena {
     public:
@@ -17,43 +33,266 @@ class Arena {
         // Добавление NPC на арену
         void addNpc(std::unique_ptr<Npc> npc);
 
+        // Добавление без исключений: при ошибке NPC уничтожается,
+        // а причина возвращается кодом
+        NpcError tryAddNpc(std::unique_ptr<Npc> npc);
+
         // Создание и добавление NPC по типу
         void createAndAddNpc(const std::string& type, 
                          const std::string& name, 
                          int x, int y);
 
+        // Есть ли на арене NPC с таким именем
+        bool hasNpc(const std::string& name) const;
+
+        // Удаление NPC по имени; false, если такого NPC нет
+        bool removeNpc(const std::string& name);
+
+        // Перемещение NPC в пределах арены
+        void moveNpc(const std::string& name, int x, int y);
+
         // Вывод информации обо всех NPC
         void printAllNpcs() const;
 
         // Получение количества NPC
         size_t getNpcCount() const;
 
+        // Границы арены
+        int getWidth() const;
+
+        int getHeight() const;
+
+        // Обход всех NPC в порядке имён
+        template <typename Func>
+        void forEachNpc(Func&& func) const {
+            forEachEntry([&func](const NpcMap::value_type& entry) {
+                func(*entry.second);
+            });
+        }
+
+        // Снимок арены для боёв "что если". Основа хранилища общая с исходной
+        // ареной и не изменяется, пока разделена: каждая арена записывает свои
+        // добавления, перемещения и удаления поверх неё. Стоимость форка и
+        // последующих изменений пропорциональна числу изменений, а не размеру
+        // арены; копируются только перемещённые NPC. Наблюдатели не
+        // переносятся; форки можно изменять в разных потоках.
+        Arena fork() const;
+
         // Управление наблюдателями
         void addObserver(std::shared_ptr<Observer> observer);
 
         void removeObserver(std::shared_ptr<Observer> observer);
 
+        // События боя копятся в буфере и доставляются наблюдателям через
+        // notifyBatch пачками по batchSize событий; остаток - в конце боя.
+        // 0 - весь бой одной пачкой.
+        void setEventBatchSize(size_t batchSize);
+
+        size_t getEventBatchSize() const;
+
         // Управление боем с указанной дальностью
-        void startBattle(double range);
+        BattleResult startBattle(double range);
+
+        // Порядок хранения. В порядке Мортона бой перебирает NPC по
+        // расположению, события боя идут в этом же порядке, а сохранения
+        // пишутся по Z-кривой. forEachNpc всегда обходит NPC по имени.
+        void setStorageOrder(StorageOrder order);
+
+        StorageOrder getStorageOrder() const;
+
+        // Исходы боя для нескольких дальностей за один проход; арена не
+        // изменяется, наблюдатели не уведомляются. Результаты - в порядке ranges.
+        std::vector<BattleResult> sweepBattleRanges(const std::vector<double>& ranges) const;
+
+        // Выбор способа перебора пар в бою (по умолчанию - автоматически)
+        void setSpatialBackend(SpatialBackend backend);
+
+        SpatialBackend getSpatialBackend() const;
+
+        // Метрики последнего боя (пустые, если сбор отключён при сборке)
+        const BattleStats& getLastBattleStats() const;
+
+        // Аппаратные счётчики (такты, инструкции, промахи кэша и предсказания
+        // переходов) по фазам боя в BattleStats. По умолчанию выключены:
+        // счётчики открываются на каждый бой. Недоступные счётчики остаются пустыми.
+        void setHardwareCountersEnabled(bool enabled);
+
+        bool getHardwareCountersEnabled() const;
+
+        // Запись NPC в формате файла арены в любой приёмник; возвращает число NPC
+        size_t writeNpcs(TextSink& sink) const;
 
         // Сохранение в файл
-        void saveToFile(const std::string& filename) const;
+        SaveResult saveToFile(const std::string& filename) const;
 
         // Загрузка из файла
-        void loadFromFile(const std::string& filename);
+        // Некорректные строки пропускаются и попадают в LoadResult::errors
+        LoadResult loadFromFile(const std::string& filename);
+
+        // Асинхронное сохранение: набор NPC фиксируется форком в момент
+        // вызова, запись идёт на исполнителе; арену можно менять сразу
+        Task<SaveResult> saveAsync(std::string filename,
+                                   ThreadPool& executor = defaultIoExecutor()) const;
 
-        // Очистка арены
-        void clear();
+        // Асинхронная загрузка на исполнителе: следующий блок файла читается,
+        // пока разбирается текущий. До завершения задачи арена занята
+        // загрузкой и не должна использоваться другими потоками.
+        Task<LoadResult> loadAsync(std::string filename,
+                                   ThreadPool& executor = defaultIoExecutor());
+
+        // Очистка арены, возвращает число удалённых NPC
+        size_t clear();
+
+        // Приёмник диагностических сообщений и минимальный уровень.
+        // По умолчанию сообщения не формируются и никуда не выводятся.
+        void setDiagnostics(std::shared_ptr<DiagnosticsSink> sink,
+                            DiagLevel minLevel = DiagLevel::Info);
     
     private:
         int width_;
         int height_;
-        // Храним NPC по имени для быстрого доступа
-        std::map<std::string, std::unique_ptr<Npc>> npcs_;
+        using NpcMap = std::map<std::string, std::shared_ptr<Npc>>;
+
+        // Храним NPC по имени для быстрого доступа. Основа может быть общей
+        // с форками и изменяется на месте, только когда принадлежит одной
+        // арене (см. exclusiveBase()). Иначе изменения копятся поверх неё:
+        // overlay_ - добавленные и перемещённые NPC, tombstones_ - имена NPC
+        // основы, удалённых или перекрытых записью overlay_.
+        std::shared_ptr<NpcMap> base_;
+        NpcMap overlay_;
+        std::set<std::string> tombstones_;
+        size_t npcCount_ = 0;
 
         // Наблюдатели за событиями боя
         std::vector<std::shared_ptr<Observer>> observers_;
 
-        // Уведомление всех наблюдателей о событии
-        void notifyObservers(const std::string& event);
+        static const size_t kDefaultEventBatchSize = 1024;
+
+        // Буфер событий текущего боя (текст и структура); заполнены первые eventCount_
+        size_t eventBatchSize_ = kDefaultEventBatchSize;
+        std::vector<Event> eventBuffer_;
+        std::vector<FightEvent> fightBuffer_;
+        size_t eventCount_ = 0;
+
+        SpatialBackend spatialBackend_ = SpatialBackend::Auto;
+
+        bool hardwareCounters_ = false;
+
+        BattleStats lastBattleStats_;
+
+        std::shared_ptr<DiagnosticsSink> diagnostics_;
+        DiagLevel diagnosticsLevel_ = DiagLevel::Off;
+
+        bool diagnosticsEnabled(DiagLevel level) const;
+
+        void diagnose(DiagLevel level, const std::string& message) const;
+
+        // Снимок для боя: виды и имена NPC в порядке имён, их координаты
+        // и враждебные пары в пределах дальности
+        struct BattleSnapshot {
+            std::vector<NpcKind> kinds;
+            std::vector<const std::string*> names;
+            std::vector<SpatialPoint> points;
+            std::vector<CandidatePair> pairs;
+            PairSearchInfo search;
+        };
+
+        BattleSnapshot takeBattleSnapshot(double range) const;
+
+        // Разбор и добавление одной строки файла арены
+        void loadLine(std::string_view line, size_t lineNumber, LoadResult& result);
+
+        void reportLoaded(const LoadResult& result, const std::string& filename) const;
+
+        // Упорядоченный по ключу Мортона список NPC поддерживается
+        // изменяющими методами, константные методы его только читают, поэтому
+        // одну арену могут читать несколько потоков. Основная часть отсортирована
+        // и может быть общей с форками; добавленные и перемещённые NPC копятся
+        // в pending_, удалённые из основной части - в removed_. Когда изменений
+        // становится много относительно основной части, они сливаются с ней
+        // в новый собственный список (в среднем O(1) на изменение).
+        struct StorageEntry {
+            std::uint32_t key;
+            const Npc* npc;
+        };
+
+        // При равных ключах порядок по имени, чтобы он не зависел от истории изменений
+        struct StorageLess {
+            bool operator()(const StorageEntry& a, const StorageEntry& b) const {
+                return a.key != b.key ? a.key < b.key : a.npc->getName() < b.npc->getName();
+            }
+        };
+
+        StorageOrder storageOrder_ = StorageOrder::Name;
+        std::shared_ptr<const std::vector<StorageEntry>> storage_;
+        std::set<StorageEntry, StorageLess> pending_;
+        std::unordered_set<const Npc*> removed_;
+
+        void storageInsert(const Npc& npc);
+
+        void storageErase(const Npc& npc);
+
+        // Слияние pending_ и removed_ с основной частью, если их накопилось много
+        void compactStorage();
+
+        // Обход NPC в порядке хранения
+        template <typename Func>
+        void forEachStored(Func&& func) const {
+            if (storageOrder_ == StorageOrder::Name) {
+                forEachEntry([&func](const NpcMap::value_type& entry) {
+                    func(*entry.second);
+                });
+                return;
+            }
+            auto added = pending_.begin();
+            StorageLess less;
+            for (const StorageEntry& entry : *storage_) {
+                if (!removed_.empty() && removed_.count(entry.npc) > 0) {
+                    continue;
+                }
+                while (added != pending_.end() && less(*added, entry)) {
+                    func(*(added++)->npc);
+                }
+                func(*entry.npc);
+            }
+            for (; added != pending_.end(); ++added) {
+                func(*added->npc);
+            }
+        }
+
+        // Обход записей в порядке имён: основа без удалённых и overlay_
+        template <typename Func>
+        void forEachEntry(Func&& func) const {
+            auto added = overlay_.begin();
+            auto removed = tombstones_.begin();
+            for (const auto& entry : *base_) {
+                while (added != overlay_.end() && added->first < entry.first) {
+                    func(*added++);
+                }
+                if (removed != tombstones_.end() && *removed == entry.first) {
+                    ++removed;
+                    continue;
+                }
+                func(entry);
+            }
+            for (; added != overlay_.end(); ++added) {
+                func(*added);
+            }
+        }
+
+        const NpcMap::value_type* findEntry(const std::string& name) const;
+
+        // Основа для изменения на месте, если она больше ни с кем не
+        // разделена (накопленные изменения при этом вливаются в неё);
+        // nullptr, если основа общая с форком
+        NpcMap* exclusiveBase();
+
+        // Удаление NPC по упорядоченному списку имён; все имена существуют
+        void eraseEntries(const std::vector<std::string>& names);
+
+        // Добавление схватки и её текста в буфер событий
+        void bufferEvent(const FightEvent& fight);
+
+        // Доставка накопленных событий всем наблюдателям
+        void flushEvents();
 };
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "expected.h"
+
+// Результат сохранения арены в файл
+struct SaveResult {
+    size_t saved = 0;
+};
+
+// Ошибка загрузки одной строки (записи) файла
+struct LoadError {
+    size_t line = 0;
+    NpcError error;
+
+    std::string message() const { return error.message(); }
+};
+
+// Результат загрузки арены из файла
+struct LoadResult {
+    size_t loaded = 0;
+    std::vector<LoadError> errors;
+};
+
+// Результат боя
+struct BattleResult {
+    double range = 0.0;
+    size_t npcsBefore = 0;
+    size_t npcsAfter = 0;
+    size_t fights = 0;
+    // Имена погибших NPC в порядке возрастания
+    std::vector<std::string> killed;
+};
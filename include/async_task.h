@@ -0,0 +1,227 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "thread_pool.h"
+
+// Асинхронная задача на сопрограммах C++20. Задача ленивая: тело начинает
+// выполняться при первом co_await (или явном start()), результат и исключение
+// передаются ожидающей сопрограмме. Ожидающий возобновляется в том потоке,
+// где задача завершилась.
+template <typename T>
+class Task;
+
+namespace detail {
+
+// Общая часть обещания: ожидающая сопрограмма и флаг "встретились",
+// который выставляют и завершившаяся задача, и ожидающий - второй из них
+// продолжает выполнение
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::atomic<bool> rendezvous{false};
+    std::exception_ptr error;
+    bool started = false;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> self) noexcept {
+            TaskPromiseBase& promise = self.promise();
+            if (promise.rendezvous.exchange(true, std::memory_order_acq_rel)) {
+                return promise.continuation;
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() { error = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+
+    template <typename U>
+    void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+
+    T take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+
+    void return_void() {}
+
+    void take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+}
+
+template <typename T = void>
+class Task {
+    public:
+        using promise_type = detail::TaskPromise<T>;
+        using Handle = std::coroutine_handle<promise_type>;
+
+        Task() = default;
+        explicit Task(Handle handle) : handle_(handle) {}
+
+        Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                reset();
+                handle_ = std::exchange(other.handle_, {});
+            }
+            return *this;
+        }
+
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        // Запущенную задачу нужно дождаться до уничтожения
+        ~Task() { reset(); }
+
+        // Запуск без ожидания: тело выполняется до первой приостановки,
+        // например до перехода на поток исполнителя
+        void start() {
+            promise_type& promise = handle_.promise();
+            if (!promise.started) {
+                promise.started = true;
+                handle_.resume();
+            }
+        }
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> awaiting) {
+            handle_.promise().continuation = awaiting;
+            start();
+            // Если задача уже завершилась, ожидающий продолжает без приостановки
+            return !handle_.promise().rendezvous.exchange(true, std::memory_order_acq_rel);
+        }
+
+        T await_resume() { return handle_.promise().take(); }
+
+    private:
+        Handle handle_;
+
+        void reset() {
+            if (handle_) {
+                handle_.destroy();
+                handle_ = {};
+            }
+        }
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// Сопрограмма без результата, освобождающая себя по завершении
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+template <typename T>
+struct SyncWaitState {
+    std::mutex mutex;
+    std::condition_variable done;
+    bool finished = false;
+    std::conditional_t<std::is_void_v<T>, bool, std::optional<T>> value{};
+    std::exception_ptr error;
+};
+
+template <typename T>
+DetachedTask awaitAndSignal(Task<T>& task, SyncWaitState<T>& state) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await task;
+        } else {
+            state.value.emplace(co_await task);
+        }
+    } catch (...) {
+        state.error = std::current_exception();
+    }
+    // Уведомление под блокировкой: после него состояние может быть уничтожено
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.finished = true;
+    state.done.notify_one();
+}
+
+}
+
+// Переход сопрограммы на поток пула: co_await schedule(pool)
+struct ScheduleAwaiter {
+    ThreadPool& pool;
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        pool.submit([handle] { handle.resume(); });
+    }
+
+    void await_resume() const noexcept {}
+};
+
+inline ScheduleAwaiter schedule(ThreadPool& pool) {
+    return {pool};
+}
+
+// Блокирующее ожидание задачи из обычного кода. Нельзя вызывать из потока
+// пула, на котором задача должна выполниться, - он будет занят ожиданием.
+template <typename T>
+T syncWait(Task<T> task) {
+    detail::SyncWaitState<T> state;
+    detail::awaitAndSignal(task, state);
+    {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.done.wait(lock, [&state] { return state.finished; });
+    }
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*state.value);
+    }
+}
+
+// Исполнитель ввода-вывода по умолчанию для асинхронных операций арены
+ThreadPool& defaultIoExecutor();
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "npc_kind.h"
+
+// Один прогон серии: исходная расстановка и дальности, на которых
+// проводятся независимые бои (каждый - с исходного состояния)
+struct BatchJob {
+    // Файл с NPC; если пуст - случайная расстановка по seed и npcCount
+    std::string sourceFile;
+    unsigned seed = 0;
+    size_t npcCount = 0;
+    std::vector<double> ranges;
+};
+
+// Выживаемость NPC одного вида
+struct KindSurvival {
+    size_t initial = 0;
+    size_t survived = 0;
+
+    double rate() const;
+};
+
+// Сводка по всем боям на одной дальности
+struct RangeSummary {
+    double range = 0.0;
+    size_t battles = 0;
+    size_t fights = 0;
+    KindSurvival kinds[kNpcKindCount];
+};
+
+// Итог серии прогонов
+struct BatchSummary {
+    size_t jobs = 0;
+    size_t failedJobs = 0;
+    size_t threads = 0;
+    double elapsedMs = 0.0;
+    // Сводки, упорядоченные по возрастанию дальности
+    std::vector<RangeSummary> ranges;
+
+    void print(std::ostream& os) const;
+};
+
+// Запуск множества независимых арен на пуле потоков с перехватом задач.
+// У каждого рабочего потока своя арена, буфер расстановки и буфер строки
+// файла; буферы переиспользуются между прогонами, а NPC арены создаются
+// по расстановке заново, по одному разу на прогон. Итоги собираются по
+// потокам и объединяются в конце.
+class BatchRunner {
+    public:
+        explicit BatchRunner(size_t threadCount = 0);
+
+        BatchSummary run(const std::vector<BatchJob>& jobs) const;
+
+        // Случайные расстановки для исследования методом Монте-Карло
+        static std::vector<BatchJob> generateJobs(size_t count,
+                                                  size_t npcCount,
+                                                  const std::vector<double>& ranges,
+                                                  unsigned seed);
+
+    private:
+        size_t threadCount_;
+};
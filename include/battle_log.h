@@ -0,0 +1,160 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "compact_arena.h"
+#include "observer.h"
+
+// Двоичный журнал боёв. Файл отображается в память и растёт удвоением;
+// события пишутся записями фиксированного размера подряд, бой за боем.
+// При закрытии за записями дописываются таблица имён, индекс боёв и
+// индекс по NPC, а заголовок получает их смещения.
+// Отображение в память сделано средствами POSIX, поэтому журнал собирается
+// только там (опция CMake ARENA_ENABLE_BATTLE_LOG, вне POSIX выключена).
+//
+// Формат файла (little-endian, как в памяти):
+//   BattleLogHeader
+//   BattleLogRecord[recordCount]                 - события в порядке боёв
+//   uint32_t[nameCount + 1] + символы            - смещения и символы имён
+//   uint32_t[nameCount]                          - номера имён по алфавиту
+//   BattleLogBattle[battleCount]                 - индекс боёв
+//   BattleLogNpcEntry[npcEntryCount]             - (номер имени, запись), по возрастанию
+
+// Событие журнала: first убил second либо оба погибли
+struct BattleLogRecord {
+    std::uint32_t battle;
+    std::uint32_t first;
+    std::uint32_t second;
+    NpcKind firstKind;
+    NpcKind secondKind;
+    std::uint8_t mutual;
+    std::uint8_t reserved;
+};
+
+static_assert(sizeof(BattleLogRecord) == 16, "BattleLogRecord must stay 16 bytes");
+
+// Запись индекса боёв: дальность и диапазон событий боя
+struct BattleLogBattle {
+    double range;
+    std::uint64_t firstRecord;
+    std::uint64_t recordCount;
+};
+
+// Запись индекса по NPC: номер имени и номер события с его участием
+struct BattleLogNpcEntry {
+    std::uint32_t name;
+    std::uint32_t reserved;
+    std::uint64_t record;
+};
+
+struct BattleLogHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t finished;
+    std::uint64_t recordCount;
+    std::uint64_t battleCount;
+    std::uint64_t nameCount;
+    std::uint64_t npcEntryCount;
+    std::uint64_t namesOffset;
+    std::uint64_t battlesOffset;
+    std::uint64_t npcIndexOffset;
+};
+
+// Наблюдатель, пишущий бои арены в двоичный журнал. Текстовые события
+// не используются - только структурированные схватки.
+class BattleLogObserver : public Observer {
+    public:
+        explicit BattleLogObserver(const std::string& filename);
+
+        ~BattleLogObserver() override;
+
+        BattleLogObserver(const BattleLogObserver&) = delete;
+        BattleLogObserver& operator=(const BattleLogObserver&) = delete;
+
+        void notify(const std::string& event) override;
+
+        void notifyFights(std::span<const FightEvent> fights) override;
+
+        void battleStarted(double range) override;
+
+        void battleFinished() override;
+
+        // Запись индексов и закрытие файла; после него события не принимаются
+        void close();
+
+        size_t getRecordCount() const;
+
+    private:
+        std::string filename_;
+        int fd_ = -1;
+        char* data_ = nullptr;
+        size_t capacity_ = 0;
+        size_t size_ = 0;
+
+        NameTable names_;
+        std::vector<BattleLogBattle> battles_;
+        size_t recordCount_ = 0;
+        bool inBattle_ = false;
+
+        void reserve(size_t bytes);
+
+        void append(const void* bytes, size_t length);
+
+        void updateHeader(bool finished);
+
+        // Таблица имён, индексы боёв и NPC за записями; заголовок закрытого журнала
+        void writeIndexes();
+};
+
+// Чтение журнала боёв без разбора всего файла: файл отображается в память,
+// бой находится по номеру, события NPC - двоичным поиском по индексу.
+class BattleLogReader {
+    public:
+        // Исключение runtime_error, если файл не журнал или не закрыт
+        explicit BattleLogReader(const std::string& filename);
+
+        ~BattleLogReader();
+
+        BattleLogReader(const BattleLogReader&) = delete;
+        BattleLogReader& operator=(const BattleLogReader&) = delete;
+
+        size_t getBattleCount() const;
+
+        size_t getRecordCount() const;
+
+        // Сведения о бое; out_of_range для несуществующего номера
+        const BattleLogBattle& battle(size_t index) const;
+
+        // События боя подряд, как они были записаны
+        std::span<const BattleLogRecord> battleRecords(size_t index) const;
+
+        // Номер боя, к которому относится событие: O(log боёв)
+        size_t battleOfRecord(size_t record) const;
+
+        // Все события с участием NPC в порядке записи: O(log n + k)
+        std::vector<BattleLogRecord> npcRecords(std::string_view name) const;
+
+        // Имя по номеру из записи
+        std::string_view name(std::uint32_t id) const;
+
+        // Номер имени или NameTable::kNoName: O(log имён)
+        std::uint32_t findName(std::string_view name) const;
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+
+        const BattleLogHeader* header_ = nullptr;
+        const BattleLogRecord* records_ = nullptr;
+        const std::uint32_t* nameOffsets_ = nullptr;
+        const char* nameChars_ = nullptr;
+        const std::uint32_t* sortedNames_ = nullptr;
+        const BattleLogBattle* battles_ = nullptr;
+        const BattleLogNpcEntry* npcIndex_ = nullptr;
+
+        // Смещения имён монотонны, бои и индекс NPC ссылаются на существующие записи
+        bool referencesValid() const;
+};
@@ -0,0 +1,100 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "npc_kind.h"
+#include "perf_counters.h"
+
+// Сбор статистики боя включается при сборке (опция CMake ARENA_ENABLE_STATS)
+#ifndef ARENA_ENABLE_STATS
+#define ARENA_ENABLE_STATS 1
+#endif
+
+// Метрики одного боя
+struct BattleStats {
+    double range = 0.0;
+    std::string backend;
+
+    size_t npcsBefore = 0;
+    size_t npcsAfter = 0;
+
+    // Пары, для которых считалось расстояние, и пары в пределах дальности
+    size_t pairsConsidered = 0;
+    size_t pairsInRange = 0;
+    size_t fights = 0;
+
+    // Убийства: [вид атакующего][вид погибшего]
+    size_t kills[kNpcKindCount][kNpcKindCount] = {};
+
+    // Время фаз боя в наносекундах
+    std::uint64_t candidateNs = 0;
+    std::uint64_t combatNs = 0;
+    std::uint64_t dispatchNs = 0;
+    std::uint64_t removalNs = 0;
+
+    // Аппаратные счётчики фаз (Arena::setHardwareCountersEnabled).
+    // countersTracked - были ли они включены в этом бою; недоступные
+    // счётчики не помечены в PhaseCounters::available и пишутся в JSON как null
+    bool countersTracked = false;
+    PhaseCounters candidateCounters;
+    PhaseCounters combatCounters;
+    PhaseCounters dispatchCounters;
+    PhaseCounters removalCounters;
+
+    // Число выделений памяти потоком боя за бой (только при ARENA_COUNT_ALLOCATIONS)
+    bool allocationsTracked = false;
+    std::uint64_t allocations = 0;
+
+    size_t totalKills() const;
+
+    void writeJson(std::ostream& os) const;
+
+    std::string toJson() const;
+};
+
+// Число выделений памяти текущим потоком; без ARENA_COUNT_ALLOCATIONS всегда 0
+bool allocationCountingEnabled();
+
+std::uint64_t allocationCount();
+
+// Замер длительности фазы: добавляет прошедшее время к счётчику при разрушении.
+// С набором аппаратных счётчиков добавляет и их значения за фазу к counted.
+class PhaseTimer {
+    public:
+        explicit PhaseTimer(std::uint64_t& target, PerfCounters* counters = nullptr,
+                            PhaseCounters* counted = nullptr)
+#if ARENA_ENABLE_STATS
+            : target_(target), counters_(counted ? counters : nullptr), counted_(counted) {
+            if (counters_) {
+                counters_->start();
+            }
+            start_ = std::chrono::steady_clock::now();
+        }
+#else
+        { (void)target; (void)counters; (void)counted; }
+#endif
+
+        ~PhaseTimer() {
+#if ARENA_ENABLE_STATS
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            if (counters_) {
+                *counted_ += counters_->stop();
+            }
+            target_ += static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+#endif
+        }
+
+        PhaseTimer(const PhaseTimer&) = delete;
+        PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+#if ARENA_ENABLE_STATS
+    private:
+        std::uint64_t& target_;
+        PerfCounters* counters_;
+        PhaseCounters* counted_;
+        std::chrono::steady_clock::time_point start_;
+#endif
+};
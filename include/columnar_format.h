@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "arena.h"
+
+// Сжатый поколоночный формат сохранения NPC.
+// NPC сортируются по ключу Мортона и пишутся независимыми блоками:
+//   - колонка типов: серии (номер типа, длина серии);
+//   - координаты: разности с предыдущим NPC в zigzag-varint;
+//   - имена: front coding (длина общего префикса с предыдущим + хвост).
+// Каждый блок предваряется своей длиной и кодируется с нуля, поэтому файл
+// читается потоково, а прочитанные блоки декодируются параллельно.
+class ColumnarFormat {
+    public:
+        static const size_t kDefaultBlockSize = 4096;
+
+        // Сохранение арены; возвращает число записанных байт
+        static size_t save(const Arena& arena,
+                           const std::string& filename,
+                           size_t blockSize = kDefaultBlockSize);
+
+        // Загрузка в арену с декодированием блоков на threads потоках
+        static LoadResult load(Arena& arena,
+                               const std::string& filename,
+                               size_t threads = 1);
+};
+
+// Декодированная запись NPC
+struct ColumnarNpc {
+    std::string type;
+    std::string name;
+    int x = 0;
+    int y = 0;
+};
+
+// Запись для кодирования блока: номер типа в таблице типов файла
+struct ColumnarBlockNpc {
+    std::uint32_t typeId = 0;
+    int x = 0;
+    int y = 0;
+    std::string_view name;
+};
+
+// Кодирование одного независимого блока (колонки типов, координат и имён)
+void encodeColumnarBlock(std::span<const ColumnarBlockNpc> npcs, std::vector<char>& out);
+
+// Декодирование блока; types - таблица типов, на которую ссылаются номера
+void decodeColumnarBlock(const char* data, size_t size, const std::vector<std::string>& types,
+                         std::vector<ColumnarNpc>& out);
+
+// Потоковое чтение файла поколоночного формата блок за блоком
+class ColumnarReader {
+    public:
+        explicit ColumnarReader(const std::string& filename);
+
+        // Чтение очередного закодированного блока; false в конце данных
+        bool readBlock(std::vector<char>& block);
+
+        // Декодирование блока; потокобезопасно, не зависит от других блоков
+        void decodeBlock(const std::vector<char>& block, std::vector<ColumnarNpc>& out) const;
+
+        size_t getBlockCount() const;
+
+        size_t getNpcCount() const;
+
+    private:
+        // Предел длины блока: защита от повреждённой длины в файле
+        static const std::uint64_t kMaxBlockBytes = std::uint64_t{1} << 30;
+
+        std::ifstream in_;
+        std::uint64_t fileSize_ = 0;
+        std::vector<std::string> types_;
+        size_t blockCount_ = 0;
+        size_t npcCount_ = 0;
+        size_t blocksRead_ = 0;
+
+        // Байты файла после текущей позиции чтения
+        std::uint64_t remainingBytes();
+};
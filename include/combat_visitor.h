@@ -5,19 +5,12 @@
 class CombatVisitor : public Visitor {
     public:
         // Метод: может ли атакующий убить защищающегося?
+        // Правила берутся из NpcRegistry по видам NPC.
         bool canKill(Npc* attacker, Npc* defender);
 
+        using Visitor::visit;
+
         void visit(Dragon&) override {}
         void visit(Elf&) override {}
         void visit(Druid&) override {}
-    
-    private:
-        // Дракон нападает на эльфов
-        bool dragonVs(const std::string& defenderType);
-        
-        // Эльф нападает на друидов
-        bool elfVs(const std::string& defenderType);
-        
-        // Друид нападает на драконов
-        bool druidVs(const std::string& defenderType);
 };
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "arena.h"
+#include "arena_results.h"
+#include "npc_kind.h"
+
+// Компактная запись NPC - 8 байт: 16-битные координаты (границы арены
+// не превышают 500) и 32-битное слово с видом (2 старших бита) и
+// номером имени в таблице имён (30 бит, до 2^30 - 1 имён; общий объём
+// символов имён ограничен таблицей имён)
+class CompactNpc {
+    public:
+        static constexpr std::uint32_t kMaxNameId = (1u << 30) - 1;
+        static constexpr std::size_t kMaxKinds = 4;
+
+        CompactNpc() = default;
+        CompactNpc(NpcKind kind, int x, int y, std::uint32_t nameId);
+
+        NpcKind getKind() const { return static_cast<NpcKind>(packed_ >> 30); }
+        std::uint32_t getNameId() const { return packed_ & kMaxNameId; }
+        int getX() const { return x_; }
+        int getY() const { return y_; }
+
+        void setPosition(int x, int y);
+
+    private:
+        std::uint16_t x_ = 0;
+        std::uint16_t y_ = 0;
+        std::uint32_t packed_ = 0;
+};
+
+static_assert(sizeof(CompactNpc) == 8, "CompactNpc must stay 8 bytes");
+
+// Таблица интернированных имён: символы всех имён подряд, смещения и
+// открытая адресация по хешу. Имя получает постоянный номер.
+// Смещения 32-битные (в таком виде их пишет и журнал боёв), поэтому
+// символы всех имён занимают не больше kMaxNameBytes; сверх этого
+// intern бросает std::length_error.
+class NameTable {
+    public:
+        static constexpr std::uint32_t kNoName = 0xFFFFFFFFu;
+        static constexpr std::size_t kMaxNameBytes = 0xFFFFFFFFu;
+
+        // Номер имени; новое имя добавляется в таблицу
+        std::uint32_t intern(std::string_view name);
+
+        // Номер имени или kNoName
+        std::uint32_t find(std::string_view name) const;
+
+        std::string_view name(std::uint32_t id) const;
+
+        size_t size() const;
+
+        size_t bytesUsed() const;
+
+    private:
+        std::vector<char> chars_;
+        std::vector<std::uint32_t> offsets_ = {0};
+        std::vector<std::uint32_t> slots_;
+
+        static std::uint32_t hash(std::string_view name);
+
+        void rehash(size_t slotCount);
+};
+
+// Арена, хранящая только компактные записи. Подходит для задач, упирающихся
+// в память: миллионы NPC без объектов иерархии и узлов std::map.
+// Поддерживаются не более четырёх видов (номера 0-3); NPC хранятся в
+// порядке добавления, удаление переносит последнюю запись на место удалённой.
+// Имена удалённых NPC остаются в таблице имён.
+class CompactArena {
+    public:
+        CompactArena(int width = MAX_WIDTH, int height = MAX_HEIGHT);
+
+        // Добавление без исключений; вид, не помещающийся в 2 бита, - UnknownType
+        NpcError tryAddNpc(std::string_view type, std::string_view name, int x, int y);
+
+        // То же с исключениями, как Arena::createAndAddNpc
+        void createAndAddNpc(const std::string& type, const std::string& name, int x, int y);
+
+        bool removeNpc(std::string_view name);
+
+        size_t getNpcCount() const;
+
+        // func(const CompactNpc&, std::string_view name)
+        template <typename Func>
+        void forEachNpc(Func&& func) const {
+            for (const CompactNpc& npc : npcs_) {
+                func(npc, names_.name(npc.getNameId()));
+            }
+        }
+
+        // Бой по тем же правилам, что и Arena::startBattle (без наблюдателей)
+        BattleResult startBattle(double range);
+
+        // Копия обычной арены с её границами
+        static CompactArena fromArena(const Arena& arena);
+
+        // Память под записи, индексы и таблицу имён (по ёмкости контейнеров)
+        size_t bytesUsed() const;
+
+    private:
+        static constexpr std::uint32_t kNoSlot = 0xFFFFFFFFu;
+
+        int width_;
+        int height_;
+        std::vector<CompactNpc> npcs_;
+        NameTable names_;
+        // Номер записи по номеру имени (kNoSlot - имя не на арене)
+        std::vector<std::uint32_t> slotOfName_;
+};
@@ -1,10 +1,22 @@
 #pragma once
 #include "observer.h"
 #include <iostream>
+#include <string>
 
 class ConsoleObserver : public Observer {
     public:
         void notify(const std::string& event) override {
             std::cout << "[BATTLE] " << event << std::endl;
         }
-};
\ No newline at end of file
+
+        // Пачка выводится целиком и сбрасывается один раз
+        void notifyBatch(std::span<const Event> events) override {
+            std::string text;
+            for (const Event& event : events) {
+                text += "[BATTLE] ";
+                text += event;
+                text += '\n';
+            }
+            std::cout << text << std::flush;
+        }
+};
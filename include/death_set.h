@@ -0,0 +1,43 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Погибшие в бою: по биту на NPC, номер - позиция NPC в снимке арены.
+// Отметки коммутативны и идемпотентны, поэтому результат не зависит от
+// порядка обработки пар; частичные множества потоков объединяются merge.
+class DeathSet {
+    public:
+        explicit DeathSet(std::size_t size = 0) : size_(size), words_((size + 63) / 64, 0) {}
+
+        void mark(std::size_t index) {
+            words_[index / 64] |= std::uint64_t{1} << (index % 64);
+        }
+
+        bool contains(std::size_t index) const {
+            return (words_[index / 64] >> (index % 64)) & 1u;
+        }
+
+        void merge(const DeathSet& other) {
+            for (std::size_t i = 0; i < words_.size() && i < other.words_.size(); ++i) {
+                words_[i] |= other.words_[i];
+            }
+        }
+
+        std::size_t count() const {
+            std::size_t total = 0;
+            for (std::uint64_t word : words_) {
+                total += static_cast<std::size_t>(std::popcount(word));
+            }
+            return total;
+        }
+
+        std::size_t size() const {
+            return size_;
+        }
+
+    private:
+        std::size_t size_;
+        std::vector<std::uint64_t> words_;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <iostream>
+#include <string>
+
+// Уровень важности диагностических сообщений
+enum class DiagLevel {
+    Debug = 0,
+    Info = 1,
+    Warning = 2,
+    Error = 3,
+    Off = 4
+};
+
+// Приёмник диагностических сообщений арены
+class DiagnosticsSink {
+    public:
+        virtual ~DiagnosticsSink() = default;
+        virtual void write(DiagLevel level, const std::string& message) = 0;
+};
+
+// Приёмник по умолчанию: сообщения отбрасываются
+class NullDiagnosticsSink : public DiagnosticsSink {
+    public:
+        void write(DiagLevel, const std::string&) override {}
+};
+
+// Вывод на консоль: предупреждения и ошибки - в std::cerr, остальное - в std::cout.
+// Строки завершаются '\n' без принудительного сброса буфера.
+class ConsoleDiagnosticsSink : public DiagnosticsSink {
+    public:
+        void write(DiagLevel level, const std::string& message) override {
+            if (level >= DiagLevel::Warning) {
+                std::cerr << message << '\n';
+            } else {
+                std::cout << message << '\n';
+            }
+        }
+};
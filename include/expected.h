@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <utility>
+#include "factory.h"
+
+// Код ошибки создания или добавления NPC
+enum class NpcErrorCode {
+    None,
+    ParseFailed,
+    CoordinatesOutOfRange,
+    UnknownType,
+    OutOfArenaBounds,
+    DuplicateName
+};
+
+// Ошибка без сообщения: текст строится только по запросу
+struct NpcError {
+    NpcErrorCode code = NpcErrorCode::None;
+    // Для ошибок разбора строки
+    ParseError parse = ParseError::None;
+    size_t column = 0;
+
+    bool ok() const { return code == NpcErrorCode::None; }
+
+    std::string message() const;
+};
+
+// Значение или ошибка - упрощённый аналог std::expected (C++23)
+template <typename T>
+class Expected {
+    public:
+        Expected(T value) : value_(std::move(value)) {}
+        Expected(NpcError error) : error_(error) {}
+
+        bool hasValue() const { return error_.ok(); }
+        explicit operator bool() const { return hasValue(); }
+
+        T& value() { return value_; }
+        const T& value() const { return value_; }
+        T& operator*() { return value_; }
+        T* operator->() { return &value_; }
+
+        const NpcError& error() const { return error_; }
+
+    private:
+        T value_{};
+        NpcError error_;
+};
@@ -1,11 +1,43 @@
 #pragma once
 #include <memory>
 #include <string>
+#include <string_view>
 #include "npc.h"
 
+struct NpcError;
+template <typename T> class Expected;
+
+// Код ошибки разбора строки NPC
+enum class ParseError {
+    None,
+    MissingType,
+    MissingName,
+    BadX,
+    BadY,
+    OutOfRange
+};
+
+const char* parseErrorMessage(ParseError error);
+
+// Итог разбора: код ошибки и позиция (с 1), на которой она обнаружена
+struct ParseStatus {
+    ParseError error = ParseError::None;
+    size_t column = 0;
+
+    bool ok() const { return error == ParseError::None; }
+};
+
+// Разобранная строка; type и name указывают внутрь исходной строки
+struct ParsedNpcLine {
+    std::string_view type;
+    std::string_view name;
+    int x = 0;
+    int y = 0;
+};
+
 class NpcFactory {
     public:
-        // Создание NPC по типу
+        // Создание NPC по типу через NpcRegistry
         static std::unique_ptr<Npc> createNpc(
             const std::string& type,
             const std::string& name,
@@ -16,4 +48,18 @@ class NpcFactory {
         // Загрузка NPC из строки файла
         // Формат строки: "Тип Имя X Y"
         static std::unique_ptr<Npc> createFromString(const std::string& line);
-};
\ No newline at end of file
+
+        // Разбор строки без выделения памяти и исключений.
+        // Тип вида здесь не проверяется - это делает createNpc.
+        static ParseStatus parseLine(std::string_view line, ParsedNpcLine& out) noexcept;
+
+        // Варианты без исключений: ошибка возвращается кодом (см. expected.h)
+        static Expected<std::unique_ptr<Npc>> tryCreateNpc(
+            std::string_view type,
+            std::string_view name,
+            int x,
+            int y
+        );
+
+        static Expected<std::unique_ptr<Npc>> tryCreateFromString(std::string_view line);
+};
@@ -13,7 +13,26 @@ class FileObserver : public Observer {
                 file << event << std::endl;
             }
         }
+
+        // Вся пачка дописывается одним открытием файла и одной записью
+        void notifyBatch(std::span<const Event> events) override {
+            std::string text;
+            size_t length = 0;
+            for (const Event& event : events) {
+                length += event.size() + 1;
+            }
+            text.reserve(length);
+            for (const Event& event : events) {
+                text += event;
+                text += '\n';
+            }
+
+            std::ofstream file(filename, std::ios::app);
+            if (file.is_open()) {
+                file.write(text.data(), static_cast<std::streamsize>(text.size()));
+            }
+        }
     
     private:
         std::string filename;
-};
\ No newline at end of file
+};
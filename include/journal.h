@@ -0,0 +1,68 @@
+#pragma once
+#include <memory>
+#include <string>
+#include "arena.h"
+#include "npc_writer.h"
+
+// Журнал упреждающей записи для арены.
+// Каждое изменение дописывается в конец журнала одной строкой, поэтому
+// стоимость сохранения правки не зависит от размера подземелья. Запись
+// сбрасывается на диск (fsync) до того, как изменение применяется к арене, а
+// недопустимые изменения отклоняются до записи: при ошибке записи арена
+// не меняется, а после сбоя или отключения питания журнал не отстаёт от
+// памяти. Периодически арена целиком сохраняется в снимок (checkpoint), а
+// журнал обнуляется - только после того, как снимок лёг на диск.
+//
+// Формат записей журнала:
+//   A <Тип> <Имя> <X> <Y>      - добавление NPC
+//   R <Имя>                    - удаление NPC
+//   M <Имя> <X> <Y>            - перемещение NPC
+//   B <Дальность> <Имя>...     - итог боя: имена погибших
+class ArenaJournal {
+    public:
+        // checkpointInterval - число записей, после которого снимок делается
+        // автоматически (0 - только вручную через checkpoint())
+        ArenaJournal(Arena& arena,
+                     const std::string& snapshotFile,
+                     const std::string& journalFile,
+                     size_t checkpointInterval = 1000);
+
+        void createAndAddNpc(const std::string& type,
+                             const std::string& name,
+                             int x, int y);
+
+        bool removeNpc(const std::string& name);
+
+        void moveNpc(const std::string& name, int x, int y);
+
+        BattleResult startBattle(double range);
+
+        // Полное сохранение арены в снимок и очистка журнала
+        void checkpoint();
+
+        // Число записей после последнего снимка
+        size_t getPendingRecords() const;
+
+        // Восстановление: загрузка снимка и повтор журнала поверх него.
+        // Повреждённые и неприменимые записи пропускаются.
+        // Возвращает число применённых записей журнала.
+        static size_t recover(Arena& arena,
+                              const std::string& snapshotFile,
+                              const std::string& journalFile);
+
+    private:
+        Arena& arena_;
+        std::string snapshotFile_;
+        std::string journalFile_;
+        size_t checkpointInterval_;
+        size_t pendingRecords_ = 0;
+        std::unique_ptr<FileSink> journal_;
+
+        // Запись строки журнала со сбросом на диск
+        void write(const std::string& record);
+
+        // Учёт применённой записи и автоматический снимок
+        void applied();
+
+        void checkPosition(int x, int y) const;
+};
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+// Ключ Мортона (Z-порядок) для координат арены: чередование битов X и Y.
+// Близкие на плоскости точки в большинстве случаев получают близкие ключи.
+inline std::uint32_t mortonKey(std::uint16_t x, std::uint16_t y) {
+    auto spread = [](std::uint32_t v) {
+        v = (v | (v << 8)) & 0x00FF00FFu;
+        v = (v | (v << 4)) & 0x0F0F0F0Fu;
+        v = (v | (v << 2)) & 0x33333333u;
+        v = (v | (v << 1)) & 0x55555555u;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
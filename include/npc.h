@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <memory>
+#include "npc_kind.h"
 
 class Visitor;
 
@@ -11,8 +12,11 @@ class Npc {
         virtual ~Npc() = default;
         int getX() const;
         int getY() const;
-        std::string getType() const;
-        std::string getName() const;
+        const std::string& getType() const;
+        const std::string& getName() const;
+        NpcKind getKind() const;
+
+        void setPosition(int x, int y);
 
         double distanceTo(const Npc& other) const;
         virtual void accept(Visitor& visitor) = 0;
@@ -26,4 +30,5 @@ class Npc {
         int y_;
         std::string type_;
         std::string name_;
+        NpcKind kind_;
 };
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Вид NPC: компактный номер вместо строки типа в горячем коде.
+// Встроенные виды имеют фиксированные номера, остальные получают номер
+// при регистрации в NpcRegistry.
+enum class NpcKind : std::uint8_t {
+    Dragon = 0,
+    Elf = 1,
+    Druid = 2,
+    Unknown = 7
+};
+
+// Размер таблиц, индексируемых видом (включая Unknown)
+constexpr std::size_t kNpcKindCount = 8;
+
+NpcKind kindFromType(const std::string& type);
+
+const char* kindName(NpcKind kind);
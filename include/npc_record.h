@@ -0,0 +1,71 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "npc.h"
+#include "npc_kind.h"
+#include "visitor.h"
+
+// NPC без виртуальных функций: одна конкретная запись с тегом вида.
+// Тип восстанавливается по тегу через NpcRegistry, поэтому запись не
+// хранит ни указателя на vtable, ни строки типа.
+struct NpcRecord {
+    NpcKind kind = NpcKind::Unknown;
+    int x = 0;
+    int y = 0;
+    std::string name;
+
+    static NpcRecord fromNpc(const Npc& npc);
+
+    // Объект иерархии Npc того же вида (через конструктор из реестра)
+    std::unique_ptr<Npc> toNpc() const;
+
+    const char* type() const { return kindName(kind); }
+
+    double distanceTo(const NpcRecord& other) const;
+};
+
+// Статический посетитель записей: ветвление по тегу вместо двойной
+// диспетчеризации. Derived переопределяет нужные методы (по аналогии
+// с Visitor); вызовы разрешаются при компиляции и встраиваются.
+template <typename Derived>
+class RecordVisitor {
+    public:
+        void visit(NpcRecord& record) {
+            Derived& self = static_cast<Derived&>(*this);
+            switch (record.kind) {
+                case NpcKind::Dragon: self.visitDragon(record); break;
+                case NpcKind::Elf: self.visitElf(record); break;
+                case NpcKind::Druid: self.visitDruid(record); break;
+                default: self.visitOther(record); break;
+            }
+        }
+
+        void visit(std::vector<NpcRecord>& records) {
+            for (NpcRecord& record : records) {
+                visit(record);
+            }
+        }
+
+        void visitDragon(NpcRecord&) {}
+        void visitElf(NpcRecord&) {}
+        void visitDruid(NpcRecord&) {}
+        // Виды, подключённые через NpcRegistry
+        void visitOther(NpcRecord&) {}
+};
+
+// Адаптер для существующих реализаций Visitor: запись временно
+// превращается в объект своего вида, после посещения позиция
+// переносится обратно. Медленный путь совместимости.
+void acceptRecord(NpcRecord& record, Visitor& visitor);
+
+// Все NPC арены (или любого набора) в виде записей
+template <typename Container>
+std::vector<NpcRecord> toRecords(const Container& npcs) {
+    std::vector<NpcRecord> records;
+    records.reserve(npcs.size());
+    for (const auto& npc : npcs) {
+        records.push_back(NpcRecord::fromNpc(*npc));
+    }
+    return records;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "npc.h"
+#include "npc_kind.h"
+
+// Конструктор NPC конкретного вида
+using NpcConstructor = std::unique_ptr<Npc> (*)(int x, int y, const std::string& name);
+
+// Исход встречи двух NPC; зависит только от пары видов
+enum class PairOutcome : std::uint8_t {
+    None = 0,        // не нападают друг на друга
+    FirstKills = 1,  // первый убивает второго
+    SecondKills = 2, // второй убивает первого
+    Mutual = 3       // убивают друг друга
+};
+
+// Описание зарегистрированного вида NPC
+struct NpcKindInfo {
+    std::string type;
+    NpcKind kind = NpcKind::Unknown;
+    NpcConstructor create = nullptr;
+    // Типы, на которые нападает этот вид
+    std::vector<std::string> prey;
+};
+
+// Реестр видов NPC. Каждый вид регистрирует конструктор и правила нападения;
+// поиск по строке типа идёт через совершенную хеш-функцию, которая
+// перестраивается при каждой регистрации. Новый вид подключается объектом
+// NpcRegistrar в своём файле без правок фабрики и CombatVisitor.
+class NpcRegistry {
+    public:
+        static NpcRegistry& instance();
+
+        // Регистрация вида; возвращает присвоенный номер вида
+        NpcKind registerKind(const std::string& type,
+                             NpcConstructor create,
+                             const std::vector<std::string>& prey = {});
+
+        // Поиск по строке типа за O(1); nullptr для неизвестного типа.
+        // Указатели find()/info() не меняются при регистрации новых видов
+        const NpcKindInfo* find(std::string_view type) const;
+
+        // Описание по номеру вида; nullptr для незарегистрированного номера
+        const NpcKindInfo* info(NpcKind kind) const;
+
+        // Таблица правил нападения
+        bool canKill(NpcKind attacker, NpcKind defender) const {
+            return hostile_[static_cast<size_t>(attacker)][static_cast<size_t>(defender)];
+        }
+
+        // Таблица исходов по паре видов, пересчитывается при регистрации
+        PairOutcome outcome(NpcKind first, NpcKind second) const {
+            return outcomes_[static_cast<size_t>(first)][static_cast<size_t>(second)];
+        }
+
+        size_t size() const;
+
+    private:
+        NpcRegistry();
+
+        std::vector<NpcKindInfo> kinds_;
+        // Ячейки хеш-таблицы: номер вида или -1
+        std::vector<int> slots_;
+        std::uint32_t seed_ = 0;
+        bool hostile_[kNpcKindCount][kNpcKindCount] = {};
+        PairOutcome outcomes_[kNpcKindCount][kNpcKindCount] = {};
+
+        static std::uint32_t hash(std::string_view type, std::uint32_t seed);
+
+        void rebuildHash();
+
+        void rebuildRules();
+};
+
+// Регистрация вида при статической инициализации:
+//   static NpcRegistrar goblinRegistrar("Goblin", &createGoblin, {"Dragon"});
+class NpcRegistrar {
+    public:
+        NpcRegistrar(const std::string& type,
+                     NpcConstructor create,
+                     const std::vector<std::string>& prey = {});
+};
+
+// Встроенные виды (Dragon, Elf, Druid); вызывается реестром при создании,
+// чтобы их номера совпадали с NpcKind
+void registerBuiltinNpcKinds(NpcRegistry& registry);
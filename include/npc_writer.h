@@ -0,0 +1,96 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "npc.h"
+
+// Приёмник готовых блоков текста
+class TextSink {
+    public:
+        virtual ~TextSink() = default;
+        virtual void write(const char* data, std::size_t size) = 0;
+};
+
+// Запись в файловый дескриптор системным вызовом write
+class FdSink : public TextSink {
+    public:
+        explicit FdSink(int fd);
+
+        void write(const char* data, std::size_t size) override;
+
+    private:
+        int fd_;
+};
+
+// Файл, открываемый на запись с усечением (или дозаписью в конец);
+// закрывается в деструкторе
+class FileSink : public TextSink {
+    public:
+        explicit FileSink(const std::string& filename, bool append = false);
+        ~FileSink() override;
+
+        FileSink(const FileSink&) = delete;
+        FileSink& operator=(const FileSink&) = delete;
+
+        void write(const char* data, std::size_t size) override;
+
+        // Сброс записанного на устройство (fsync, в Windows - _commit):
+        // после возврата данные переживают не только сбой процесса, но и
+        // отключение питания
+        void sync();
+
+        // Закрытие с проверкой ошибки
+        void close();
+
+    private:
+        int fd_;
+        std::string filename_;
+};
+
+// Запись в любой std::ostream (например, std::cout)
+class OstreamSink : public TextSink {
+    public:
+        explicit OstreamSink(std::ostream& os) : os_(os) {}
+
+        void write(const char* data, std::size_t size) override;
+
+    private:
+        std::ostream& os_;
+};
+
+// Буферизованный вывод NPC: поля форматируются std::to_chars в
+// переиспользуемый буфер, который сбрасывается в приёмник большими блоками
+class NpcTextWriter {
+    public:
+        explicit NpcTextWriter(TextSink& sink, std::size_t blockSize = 64 * 1024);
+
+        // Сбрасывает остаток; ошибки приёмника при этом не выбрасываются,
+        // поэтому перед завершением записи следует вызвать flush()
+        ~NpcTextWriter();
+
+        NpcTextWriter(const NpcTextWriter&) = delete;
+        NpcTextWriter& operator=(const NpcTextWriter&) = delete;
+
+        // Строка формата файла арены: "Type Name X Y\n"
+        void writeRecord(const Npc& npc);
+
+        // Строка формата operator<<: "NPC Type: T, Name: N, Position: (X, Y)"
+        void writeInfo(const Npc& npc);
+
+        void append(std::string_view text);
+
+        void append(char c);
+
+        void append(int value);
+
+        void flush();
+
+    private:
+        TextSink& sink_;
+        std::vector<char> buffer_;
+        std::size_t used_ = 0;
+
+        void reserve(std::size_t size);
+};
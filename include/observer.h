@@ -1,8 +1,42 @@
 #pragma once
+#include <span>
 #include <string>
+#include <string_view>
+#include "npc_kind.h"
+
+// Событие боя в текстовом виде
+using Event = std::string;
+
+// Схватка в структурированном виде: first убил second либо, при mutual,
+// оба погибли. Имена действительны только во время вызова наблюдателя.
+struct FightEvent {
+    std::string_view first;
+    std::string_view second;
+    NpcKind firstKind = NpcKind::Unknown;
+    NpcKind secondKind = NpcKind::Unknown;
+    bool mutual = false;
+};
 
 class Observer {
     public:
         virtual ~Observer() = default;
         virtual void notify(const std::string& event) = 0;
-};
\ No newline at end of file
+
+        // Пачка событий одного боя в порядке их возникновения. По умолчанию
+        // каждое событие передаётся в notify; наблюдатели, которым выгодно
+        // обрабатывать события разом, переопределяют этот метод.
+        virtual void notifyBatch(std::span<const Event> events) {
+            for (const Event& event : events) {
+                notify(event);
+            }
+        }
+
+        // Те же события пачки в структурированном виде; вызывается сразу
+        // после notifyBatch. По умолчанию не используется.
+        virtual void notifyFights(std::span<const FightEvent> /*fights*/) {}
+
+        // Границы боя: вызываются до первой и после последней пачки
+        virtual void battleStarted(double /*range*/) {}
+
+        virtual void battleFinished() {}
+};
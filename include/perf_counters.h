@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Аппаратные счётчики процессора (Linux perf_event_open)
+enum class HardwareCounter {
+    Cycles,
+    Instructions,
+    CacheMisses,
+    BranchMisses
+};
+
+constexpr std::size_t kHardwareCounterCount = 4;
+
+const char* hardwareCounterName(HardwareCounter counter);
+
+// Значения счётчиков за фазу. Недоступный счётчик (нет поддержки ядра или
+// процессора, запрет perf_event_paranoid, не Linux) не помечается в available.
+// При чередовании счётчиков ядром значение пересчитывается на всю фазу;
+// счётчик, не работавший ни мгновения, тоже считается недоступным.
+struct PhaseCounters {
+    std::uint64_t values[kHardwareCounterCount] = {};
+    unsigned available = 0;
+
+    bool has(HardwareCounter counter) const {
+        return (available >> static_cast<unsigned>(counter)) & 1u;
+    }
+
+    std::uint64_t get(HardwareCounter counter) const {
+        return values[static_cast<std::size_t>(counter)];
+    }
+
+    PhaseCounters& operator+=(const PhaseCounters& other);
+};
+
+// Набор счётчиков текущего потока (только пользовательский режим).
+// Каждый счётчик открывается отдельно, поэтому отсутствие одного не
+// отключает остальные; при полной недоступности start/stop ничего не делают.
+class PerfCounters {
+    public:
+        PerfCounters();
+        ~PerfCounters();
+
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters& operator=(const PerfCounters&) = delete;
+
+        // Есть ли хотя бы один открытый счётчик
+        bool available() const;
+
+        void start();
+
+        // Значения с последнего start()
+        PhaseCounters stop();
+
+    private:
+        int fds_[kHardwareCounterCount];
+};
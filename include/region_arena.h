@@ -0,0 +1,129 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <string>
+#include <vector>
+#include "arena.h"
+#include "arena_results.h"
+#include "npc_record.h"
+
+// Прямоугольная область арены, границы включительно
+struct RegionRect {
+    int minX = 0;
+    int minY = 0;
+    int maxX = 0;
+    int maxY = 0;
+
+    bool contains(int x, int y) const {
+        return x >= minX && x <= maxX && y >= minY && y <= maxY;
+    }
+};
+
+// Файл с индексом регионов: арена разбита на квадраты regionSize x regionSize,
+// NPC каждого квадрата записаны отдельным блоком поколоночного формата.
+// Заголовок и индекс (смещение, размер и число NPC блока) идут в начале
+// файла, поэтому для открытия достаточно прочитать только их.
+//
+//   RegionFileHeader
+//   типы: uint32_t длина + символы, typeCount раз
+//   RegionIndexEntry[cols * rows]     - регионы по строкам
+//   блоки регионов
+struct RegionFileHeader {
+    char magic[8];
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t regionSize;
+    std::uint32_t cols;
+    std::uint32_t rows;
+    std::uint32_t typeCount;
+    std::uint64_t npcCount;
+};
+
+struct RegionIndexEntry {
+    std::uint64_t offset;
+    std::uint32_t size;
+    std::uint32_t npcCount;
+};
+
+// Арена с загрузкой по требованию. При открытии читаются только заголовок
+// и индекс; регион подгружается при первом запросе или бое, который его
+// затрагивает. Число загруженных регионов ограничено: при превышении
+// выгружаются давно не использованные. Регионы, изменённые боем, не
+// выгружаются до сохранения - иначе изменения были бы потеряны.
+// Операция, затрагивающая больше регионов, чем позволяет предел, держит
+// их все до своего завершения.
+class RegionArena {
+    public:
+        static const int kDefaultRegionSize = 64;
+
+        // Запись обычной арены в файл регионов; возвращает число NPC
+        static size_t save(const Arena& arena, const std::string& filename,
+                           int regionSize = kDefaultRegionSize);
+
+        // maxResidentRegions - предел загруженных регионов (не меньше 1)
+        explicit RegionArena(const std::string& filename, size_t maxResidentRegions = 16);
+
+        RegionArena(const RegionArena&) = delete;
+        RegionArena& operator=(const RegionArena&) = delete;
+
+        // Число NPC всей арены (по индексу и изменениям загруженных регионов)
+        size_t getNpcCount() const;
+
+        size_t getRegionCount() const;
+
+        size_t getResidentRegionCount() const;
+
+        // Сколько раз блоки регионов читались из файла
+        size_t getRegionLoads() const;
+
+        // Обход NPC области; нужные регионы подгружаются
+        template <typename Func>
+        void forEachNpcInArea(const RegionRect& area, Func&& func) {
+            for (size_t index : touchRegions(area)) {
+                for (const NpcRecord& npc : regions_[index].npcs) {
+                    if (area.contains(npc.x, npc.y)) {
+                        func(npc);
+                    }
+                }
+            }
+            evictOverLimit();
+        }
+
+        // Бой NPC, находящихся в области, по правилам Arena::startBattle
+        BattleResult startBattle(double range, const RegionRect& area);
+
+        // Сохранение текущего состояния (с изменениями) в новый файл регионов
+        // того же разбиения; незагруженные регионы копируются из исходного файла
+        size_t saveToFile(const std::string& filename);
+
+    private:
+        struct Region {
+            RegionIndexEntry entry{};
+            bool resident = false;
+            bool dirty = false;
+            // Место в lru_; lru_.end(), если регион не загружен или изменён
+            std::list<size_t>::iterator lruPosition;
+            std::vector<NpcRecord> npcs;
+        };
+
+        std::ifstream file_;
+        std::string filename_;
+        RegionFileHeader header_{};
+        std::vector<std::string> types_;
+        std::vector<NpcKind> typeKinds_;
+        std::vector<Region> regions_;
+        // Загруженные неизменённые регионы, недавно использованные - в начале
+        std::list<size_t> lru_;
+        size_t maxResident_;
+        size_t resident_ = 0;
+        size_t loads_ = 0;
+
+        // Загрузка регионов, пересекающих область; возвращает их номера
+        std::vector<size_t> touchRegions(const RegionRect& area);
+
+        void readRegion(size_t index, std::vector<NpcRecord>& out);
+
+        void evictOverLimit();
+};
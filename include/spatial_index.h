@@ -0,0 +1,157 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "npc_kind.h"
+
+// Точка пространственного индекса: координаты NPC, его порядковый номер и вид
+struct SpatialPoint {
+    int x;
+    int y;
+    std::size_t index;
+    std::uint8_t kind = 0;
+};
+
+// Отбор пар по видам: пара точек видов a и b рассматривается, только если
+// allowed[a][b] или allowed[b][a]; остальные отбрасываются до вычисления расстояния
+struct KindPairFilter {
+    bool allowed[kNpcKindCount][kNpcKindCount] = {};
+
+    // Есть ли разрешённая пара между наборами видов (битовые маски)
+    bool anyAllowed(std::uint8_t kindsA, std::uint8_t kindsB) const;
+};
+
+// Пара NPC (first < second), находящихся на расстоянии не больше дальности боя
+struct CandidatePair {
+    std::size_t first;
+    std::size_t second;
+};
+
+// Способ перебора пар NPC в бою
+enum class SpatialBackend {
+    Auto,        // выбор по измеренному распределению NPC
+    BruteForce,  // полный перебор O(n^2)
+    UniformGrid, // равномерная сетка с ячейкой размером с дальность
+    KdTree       // k-d дерево с обходом пар узлов (dual-tree)
+};
+
+std::string spatialBackendName(SpatialBackend backend);
+
+// Точная проверка дальности, совпадающая с Npc::distanceTo
+bool withinRange(int dx, int dy, double range);
+
+// Равномерная сетка: хорошо работает на равномерно расставленных NPC
+class UniformGrid {
+    public:
+        void build(const std::vector<SpatialPoint>& points, double range);
+
+        // Возвращает число проверенных расстояний
+        size_t collectPairsWithin(double range, std::vector<CandidatePair>& out,
+                                  const KindPairFilter* filter = nullptr) const;
+
+        // Пары (запрос, точка сетки) в пределах дальности: каждая точка запроса
+        // просматривает только ячейки, пересекающие её окрестность
+        size_t collectCrossPairs(const std::vector<SpatialPoint>& queries, double range,
+                                 std::vector<CandidatePair>& out) const;
+
+    private:
+        int minX_ = 0;
+        int minY_ = 0;
+        int cellSize_ = 1;
+        int cols_ = 0;
+        int rows_ = 0;
+        // Точки, упорядоченные по ячейкам, и начало каждой ячейки (CSR)
+        std::vector<SpatialPoint> points_;
+        std::vector<std::size_t> cellStart_;
+};
+
+// K-d дерево, строится целиком за один проход (bulk build)
+class KdTree {
+    public:
+        void build(const std::vector<SpatialPoint>& points);
+
+        // Перечисление всех пар в пределах дальности обходом пар узлов;
+        // возвращает число проверенных расстояний
+        size_t collectPairsWithin(double range, std::vector<CandidatePair>& out,
+                                  const KindPairFilter* filter = nullptr) const;
+
+        // Пары (точка этого дерева, точка другого) обходом пар узлов двух деревьев
+        size_t collectCrossPairs(const KdTree& other, double range,
+                                 std::vector<CandidatePair>& out) const;
+
+        size_t getNodeCount() const;
+
+    private:
+        struct Node {
+            int minX, maxX, minY, maxY;
+            std::size_t begin, end;
+            int left = -1;
+            int right = -1;
+            // Виды точек узла (бит на вид)
+            std::uint8_t kinds = 0;
+        };
+
+        struct Traversal;
+
+        static const std::size_t kLeafSize = 8;
+
+        std::vector<SpatialPoint> points_;
+        std::vector<Node> nodes_;
+
+        int buildNode(std::size_t begin, std::size_t end);
+
+        void dualTraverse(int a, int b, Traversal& traversal) const;
+
+        void crossTraverse(const KdTree& other, int a, int b, Traversal& traversal) const;
+};
+
+// Выбор способа перебора по распределению точек: при сильной
+// кластеризации равномерная сетка деградирует, и выбирается k-d дерево
+SpatialBackend chooseSpatialBackend(const std::vector<SpatialPoint>& points, double range);
+
+// Сведения о проведённом поиске пар
+struct PairSearchInfo {
+    SpatialBackend backend = SpatialBackend::BruteForce;
+    size_t distanceChecks = 0;
+};
+
+// Все пары в пределах дальности, упорядоченные по (first, second);
+// с фильтром - только пары разрешённых сочетаний видов
+PairSearchInfo collectPairsWithin(SpatialBackend backend,
+                                  const std::vector<SpatialPoint>& points,
+                                  double range,
+                                  std::vector<CandidatePair>& out,
+                                  const KindPairFilter* filter = nullptr);
+
+// Отдельный индекс на каждый вид NPC. Бой сводится к двудольным соединениям
+// по дальности между враждебными видами (Dragon x Elf, Elf x Druid,
+// Druid x Dragon), и пары, которые не могут сражаться, не перебираются вовсе
+class KindPartitionedIndex {
+    public:
+        // Способ Auto выбирается один раз по всем точкам; индексы видов
+        // строятся одним и тем же способом
+        void build(SpatialBackend backend, const std::vector<SpatialPoint>& points, double range);
+
+        // Пары враждебных видов в пределах дальности, упорядоченные по (first, second)
+        PairSearchInfo collectPairsWithin(double range, const KindPairFilter& filter,
+                                          std::vector<CandidatePair>& out) const;
+
+        size_t getPartitionSize(NpcKind kind) const;
+
+    private:
+        struct Partition {
+            std::vector<SpatialPoint> points;
+            UniformGrid grid;
+            KdTree tree;
+        };
+
+        SpatialBackend backend_ = SpatialBackend::BruteForce;
+        Partition partitions_[kNpcKindCount];
+
+        size_t join(const Partition& a, const Partition& b, double range,
+                    std::vector<CandidatePair>& out) const;
+
+        size_t selfJoin(const Partition& partition, double range,
+                        std::vector<CandidatePair>& out) const;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "npc.h"
+#include "observer.h"
+
+// Итог потокового боя
+struct StreamBattleResult {
+    size_t read = 0;
+    size_t written = 0;
+    size_t fights = 0;
+    size_t skippedLines = 0;
+    // Наибольшее число NPC, одновременно находившихся в памяти
+    size_t peakResident = 0;
+};
+
+// Бой над файлом NPC, который не помещается в память.
+// Входной файл должен быть отсортирован по X. Он читается полосами ширины
+// не меньше дальности боя, в памяти держатся только две соседние полосы:
+// пара в пределах дальности всегда лежит в одной или в соседних полосах.
+// Правила убийств совпадают с Arena::startBattle; выжившие записываются
+// в выходной файл в формате Arena::saveToFile в порядке входного файла.
+// Уникальность имён, в отличие от Arena, не проверяется.
+class StreamBattle {
+    public:
+        explicit StreamBattle(double range, double stripWidth = 0.0);
+
+        void addObserver(std::shared_ptr<Observer> observer);
+
+        StreamBattleResult run(const std::string& inputFile, const std::string& outputFile);
+
+        double getStripWidth() const;
+
+    private:
+        struct Entry {
+            std::unique_ptr<Npc> npc;
+            bool dead = false;
+        };
+
+        double range_;
+        double stripWidth_;
+        std::vector<std::shared_ptr<Observer>> observers_;
+
+        void fight(std::vector<Entry>& previous, std::vector<Entry>& current,
+                   StreamBattleResult& result);
+
+        void notifyObservers(const std::string& event);
+};
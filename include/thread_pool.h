@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков с перехватом задач (work stealing): у каждого потока своя очередь,
+// свободный поток забирает задачи с противоположного конца чужой очереди
+class ThreadPool {
+    public:
+        explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Постановка задачи; из рабочего потока - в его собственную очередь
+        void submit(std::function<void()> task);
+
+        // Ожидание завершения всех поставленных задач; первое исключение,
+        // выброшенное задачей, пробрасывается отсюда
+        void waitIdle();
+
+        size_t getThreadCount() const;
+
+        // Номер текущего рабочего потока или -1 вне пула
+        static int currentWorker();
+
+    private:
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<WorkerQueue>> queues_;
+        std::vector<std::thread> threads_;
+
+        std::mutex waitMutex_;
+        std::condition_variable workAvailable_;
+        std::condition_variable idle_;
+        // Незавершённые задачи и задачи, ещё лежащие в очередях
+        std::atomic<size_t> pending_{0};
+        std::atomic<size_t> queued_{0};
+        std::exception_ptr firstError_;
+        std::atomic<size_t> nextQueue_{0};
+        bool stopping_ = false;
+
+        void workerLoop(size_t index);
+
+        bool tryPop(size_t index, std::function<void()>& task);
+
+        bool trySteal(size_t thief, std::function<void()>& task);
+};
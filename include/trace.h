@@ -0,0 +1,138 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Трассировка включается при сборке (опция CMake ARENA_ENABLE_TRACING);
+// без неё TraceSpan пуст и вызовы исчезают при компиляции
+#ifndef ARENA_ENABLE_TRACING
+#define ARENA_ENABLE_TRACING 1
+#endif
+
+// Завершённый отрезок времени одного потока. Имя и категория - строковые
+// литералы: в горячем пути ничего не копируется.
+struct TraceEvent {
+    const char* name = nullptr;
+    const char* category = nullptr;
+    std::uint64_t startNs = 0;
+    std::uint64_t durationNs = 0;
+    // Необязательный числовой аргумент (argName == nullptr - нет)
+    const char* argName = nullptr;
+    std::int64_t argValue = 0;
+};
+
+// Сбор отрезков в буферы потоков и выгрузка в формате Chrome trace-event
+// JSON (chrome://tracing, ui.perfetto.dev). Каждый поток пишет в свой
+// буфер: его мьютекс оспаривается только выгрузкой, а общий мьютекс
+// берётся лишь при первой записи потока. По умолчанию выключена:
+// выключенный отрезок стоит одного чтения флага.
+class Tracer {
+    public:
+        static Tracer& instance();
+
+        // Очистка буферов и начало записи; время отсчитывается от вызова
+        void start();
+
+        void stop();
+
+        bool enabled() const {
+            return enabled_.load(std::memory_order_relaxed);
+        }
+
+        // Наносекунды от start()
+        std::uint64_t now() const;
+
+        void record(const TraceEvent& event);
+
+        // Имя текущего потока на временной шкале. Буфер потока заводится
+        // только первой записью, поэтому потоки без отрезков в трассу не попадают
+        void setThreadName(const std::string& name);
+
+        size_t getEventCount() const;
+
+        // Все записанные отрезки и имена потоков
+        void writeJson(std::ostream& os) const;
+
+        void saveJson(const std::string& filename) const;
+
+    private:
+        struct ThreadBuffer {
+            std::mutex mutex;
+            std::uint32_t tid = 0;
+            std::string name;
+            std::vector<TraceEvent> events;
+        };
+
+        Tracer() = default;
+
+        std::atomic<bool> enabled_{false};
+        // Момент start() в наносекундах steady_clock
+        std::atomic<std::int64_t> epochNs_{0};
+
+        mutable std::mutex buffersMutex_;
+        // Буферы переживают свои потоки: отрезки завершившихся потоков
+        // остаются в трассе до следующего start()
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+        std::uint32_t nextTid_ = 0;
+
+        static thread_local std::shared_ptr<ThreadBuffer> localBuffer_;
+        static thread_local std::string localName_;
+
+        ThreadBuffer& localBuffer();
+};
+
+// Отрезок от создания до разрушения объекта в текущем потоке
+class TraceSpan {
+    public:
+        TraceSpan(const char* name, const char* category)
+#if ARENA_ENABLE_TRACING
+        {
+            Tracer& tracer = Tracer::instance();
+            if (tracer.enabled()) {
+                event_.name = name;
+                event_.category = category;
+                event_.startNs = tracer.now();
+                active_ = true;
+            }
+        }
+#else
+        { (void)name; (void)category; }
+#endif
+
+        ~TraceSpan() {
+#if ARENA_ENABLE_TRACING
+            if (active_) {
+                Tracer& tracer = Tracer::instance();
+                // Отрезок, начатый до перезапуска трассы, получает нулевую длину
+                std::uint64_t end = tracer.now();
+                event_.durationNs = end > event_.startNs ? end - event_.startNs : 0;
+                tracer.record(event_);
+            }
+#endif
+        }
+
+        // Числовой аргумент отрезка (например, число NPC); имя - литерал
+        void setArg(const char* name, std::int64_t value) {
+#if ARENA_ENABLE_TRACING
+            event_.argName = name;
+            event_.argValue = value;
+#else
+            (void)name; (void)value;
+#endif
+        }
+
+        TraceSpan(const TraceSpan&) = delete;
+        TraceSpan& operator=(const TraceSpan&) = delete;
+
+#if ARENA_ENABLE_TRACING
+    private:
+        TraceEvent event_;
+        bool active_ = false;
+#endif
+};
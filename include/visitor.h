@@ -3,6 +3,7 @@
 class Dragon;
 class Elf;
 class Druid;
+class Npc;
 
 class Visitor {
     public:
@@ -11,4 +12,7 @@ class Visitor {
         virtual void visit(Dragon& dragon) = 0;
         virtual void visit(Elf& elf) = 0;
         virtual void visit(Druid& druid) = 0;
+
+        // Виды, подключённые через NpcRegistry без отдельной перегрузки
+        virtual void visit(Npc&) {}
 };
\ No newline at end of file
@@ -14,6 +14,7 @@ int main() {
         std::cout << std::endl;
 
         Arena arena(500, 500);
+        arena.setDiagnostics(std::make_shared<ConsoleDiagnosticsSink>());
 
         auto consoleObserver = std::make_shared<ConsoleObserver>();
         auto fileObserver = std::make_shared<FileObserver>("log.txt");
@@ -0,0 +1,88 @@
+#include "../include/battle_stats.h"
+#include <cstdlib>
+#include <new>
+
+// Подсчёт выделений памяти через замену глобального operator new.
+// Включается отдельно (ARENA_COUNT_ALLOCATIONS), так как влияет на всю программу.
+// Счётчик у каждого потока свой: выделения других потоков (пулов, фоновых
+// сохранений, параллельных арен) не попадают в статистику боя.
+
+#ifdef ARENA_COUNT_ALLOCATIONS
+
+namespace {
+// Тривиальный тип: доступен и при создании, и при завершении потока
+thread_local std::uint64_t tAllocations = 0;
+
+void* countedAlloc(std::size_t size) {
+    tAllocations++;
+    if (size == 0) size = 1;
+    while (true) {
+        if (void* p = std::malloc(size)) {
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+}
+
+void* operator new(std::size_t size) {
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size) {
+    return countedAlloc(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAlloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAlloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+bool allocationCountingEnabled() {
+    return true;
+}
+
+std::uint64_t allocationCount() {
+    return tAllocations;
+}
+
+#else
+
+bool allocationCountingEnabled() {
+    return false;
+}
+
+std::uint64_t allocationCount() {
+    return 0;
+}
+
+#endif
@@ -1,13 +1,19 @@
 #include "../include/arena.h"
 #include "../include/factory.h"
-#include "../include/combat_visitor.h"
+#include "../include/npc_registry.h"
+#include "../include/death_set.h"
+#include "../include/npc_writer.h"
+#include "../include/morton.h"
+#include "../include/trace.h"
 #include <iostream>
 #include <memory>
 #include <fstream>
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <optional>
 #include <stdexcept>
+#include <sstream>
 
 Arena::Arena(int width, int height) {
     if (width > MAX_WIDTH || height > MAX_HEIGHT) {
@@ -18,21 +24,40 @@ Arena::Arena(int width, int height) {
     }
     this->width_ = width;
     this->height_ = height;
+    this->base_ = std::make_shared<NpcMap>();
+    this->diagnostics_ = std::make_shared<NullDiagnosticsSink>();
 }
 
 void Arena::addNpc(std::unique_ptr<Npc> npc) {
     const std::string name = npc->getName();
 
+    NpcError error = tryAddNpc(std::move(npc));
+    if (error.code == NpcErrorCode::OutOfArenaBounds) {
+        throw std::out_of_range("NPC position is out of arena bounds.");
+    }
+    if (error.code == NpcErrorCode::DuplicateName) {
+        throw std::invalid_argument("NPC with name '" + name + "' already exists.");
+    }
+}
+
+NpcError Arena::tryAddNpc(std::unique_ptr<Npc> npc) {
     if (npc->getX() < 0 || npc->getX() > width_ ||
         npc->getY() < 0 || npc->getY() > height_) {
-        throw std::out_of_range("NPC position is out of arena bounds.");
+        return {NpcErrorCode::OutOfArenaBounds};
     }
 
-    if (npcs_.find(name) != npcs_.end()) {
-        throw std::invalid_argument("NPC with name '" + name + "' already exists.");
+    if (findEntry(npc->getName()) != nullptr) {
+        return {NpcErrorCode::DuplicateName};
     }
-    
-    npcs_[name] = std::move(npc);
+    // Имя удалённого NPC общей основы остаётся помеченным: новая запись
+    // overlay_ перекрывает прежнюю
+    std::string name = npc->getName();
+    NpcMap* base = exclusiveBase();
+    NpcMap& target = base ? *base : overlay_;
+    auto it = target.emplace(std::move(name), std::move(npc)).first;
+    npcCount_++;
+    storageInsert(*it->second);
+    return {};
 }
 
 void Arena::createAndAddNpc(const std::string& type, 
@@ -42,65 +67,494 @@ void Arena::createAndAddNpc(const std::string& type,
     addNpc(std::move(npc));
 }
 
-void Arena::printAllNpcs() const {
-    if (npcs_.empty()) {
-        std::cout << "Arena is empty." << std::endl;
+bool Arena::hasNpc(const std::string& name) const {
+    return findEntry(name) != nullptr;
+}
+
+bool Arena::removeNpc(const std::string& name) {
+    const NpcMap::value_type* entry = findEntry(name);
+    if (entry == nullptr) {
+        return false;
+    }
+    storageErase(*entry->second);
+    eraseEntries({name});
+    return true;
+}
+
+void Arena::moveNpc(const std::string& name, int x, int y) {
+    const NpcMap::value_type* found = findEntry(name);
+    if (found == nullptr) {
+        throw std::invalid_argument("NPC with name '" + name + "' does not exist.");
+    }
+    if (x < 0 || x > width_ || y < 0 || y > height_) {
+        throw std::out_of_range("NPC position is out of arena bounds.");
+    }
+
+    storageErase(*found->second);
+    NpcMap::value_type* entry;
+    if (NpcMap* base = exclusiveBase()) {
+        entry = &*base->find(name);
+    } else if (auto it = overlay_.find(name); it != overlay_.end()) {
+        entry = &*it;
+    } else {
+        // NPC общей основы: запись overlay_ перекрывает его
+        tombstones_.insert(name);
+        entry = &*overlay_.emplace(name, found->second).first;
+    }
+    std::shared_ptr<Npc>& npc = entry->second;
+    if (npc.use_count() > 1) {
+        // NPC общий с форком: перемещаем собственную копию
+        const NpcKindInfo* info = NpcRegistry::instance().info(npc->getKind());
+        if (!info || !info->create) {
+            throw std::logic_error("Cannot copy NPC of unregistered type: " + npc->getType());
+        }
+        npc = info->create(npc->getX(), npc->getY(), name);
+    }
+    npc->setPosition(x, y);
+    storageInsert(*entry->second);
+}
+
+Arena Arena::fork() const {
+    // Копируются только настройки и накопленные изменения; основа и
+    // отсортированная часть порядка хранения общие
+    Arena copy(width_, height_);
+    copy.base_ = base_;
+    copy.overlay_ = overlay_;
+    copy.tombstones_ = tombstones_;
+    copy.npcCount_ = npcCount_;
+    copy.eventBatchSize_ = eventBatchSize_;
+    copy.spatialBackend_ = spatialBackend_;
+    copy.hardwareCounters_ = hardwareCounters_;
+    copy.lastBattleStats_ = lastBattleStats_;
+    copy.diagnostics_ = diagnostics_;
+    copy.diagnosticsLevel_ = diagnosticsLevel_;
+    copy.storageOrder_ = storageOrder_;
+    copy.storage_ = storage_;
+    copy.pending_ = pending_;
+    copy.removed_ = removed_;
+    return copy;
+}
+
+const Arena::NpcMap::value_type* Arena::findEntry(const std::string& name) const {
+    if (auto it = overlay_.find(name); it != overlay_.end()) {
+        return &*it;
+    }
+    auto it = base_->find(name);
+    if (it == base_->end() || tombstones_.count(name) > 0) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+Arena::NpcMap* Arena::exclusiveBase() {
+    if (base_.use_count() > 1) {
+        return nullptr;
+    }
+    if (!overlay_.empty() || !tombstones_.empty()) {
+        // Форков больше нет: изменения переносятся в основу. Узлы карты
+        // перемещаются без копирования, порядок хранения остаётся верным
+        for (const std::string& name : tombstones_) {
+            base_->erase(name);
+        }
+        tombstones_.clear();
+        base_->merge(overlay_);
+    }
+    return base_.get();
+}
+
+void Arena::eraseEntries(const std::vector<std::string>& names) {
+    if (NpcMap* base = exclusiveBase()) {
+        for (const std::string& name : names) {
+            base->erase(name);
+        }
+    } else {
+        for (const std::string& name : names) {
+            // NPC основы помечается удалённым; перемещённый NPC основы уже помечен
+            if (overlay_.erase(name) == 0) {
+                tombstones_.insert(tombstones_.end(), name);
+            }
+        }
+    }
+    npcCount_ -= names.size();
+}
+
+namespace {
+
+std::uint32_t storageKey(const Npc& npc) {
+    return mortonKey(static_cast<std::uint16_t>(npc.getX()), static_cast<std::uint16_t>(npc.getY()));
+}
+
+// Изменения, которые всегда можно держать отдельно от основной части
+const size_t kStorageSlack = 256;
+
+}
+
+void Arena::setStorageOrder(StorageOrder order) {
+    storageOrder_ = order;
+    pending_.clear();
+    removed_.clear();
+    if (order == StorageOrder::Name) {
+        storage_.reset();
         return;
     }
-    
-    std::cout << "NPCs on arena (" << npcs_.size() << " total):" << std::endl;
-    for (const auto& pair : npcs_) {
-        std::cout << "  " << *(pair.second) << std::endl;
+    auto sorted = std::make_shared<std::vector<StorageEntry>>();
+    sorted->reserve(npcCount_);
+    forEachEntry([&sorted](const NpcMap::value_type& entry) {
+        sorted->push_back({storageKey(*entry.second), entry.second.get()});
+    });
+    std::sort(sorted->begin(), sorted->end(), StorageLess());
+    storage_ = std::move(sorted);
+}
+
+StorageOrder Arena::getStorageOrder() const {
+    return storageOrder_;
+}
+
+void Arena::compactStorage() {
+    if ((pending_.size() + removed_.size()) * 8 <= storage_->size() + kStorageSlack) {
+        return;
+    }
+    // Новый список не зависит от общего с форками
+    auto merged = std::make_shared<std::vector<StorageEntry>>();
+    merged->reserve(npcCount_);
+    forEachStored([&merged](const Npc& npc) {
+        merged->push_back({storageKey(npc), &npc});
+    });
+    storage_ = std::move(merged);
+    pending_.clear();
+    removed_.clear();
+}
+
+void Arena::storageInsert(const Npc& npc) {
+    if (storageOrder_ == StorageOrder::Name) {
+        return;
+    }
+    pending_.insert({storageKey(npc), &npc});
+    compactStorage();
+}
+
+void Arena::storageErase(const Npc& npc) {
+    if (storageOrder_ == StorageOrder::Name) {
+        return;
+    }
+    auto it = pending_.find({storageKey(npc), &npc});
+    if (it != pending_.end() && it->npc == &npc) {
+        pending_.erase(it);
+        return;
     }
+    // NPC основной части: скрывается до следующего слияния
+    removed_.insert(&npc);
+    compactStorage();
+}
+
+void Arena::printAllNpcs() const {
+    OstreamSink sink(std::cout);
+    NpcTextWriter writer(sink);
+    if (npcCount_ == 0) {
+        writer.append("Arena is empty.\n");
+    } else {
+        writer.append("NPCs on arena (");
+        writer.append(static_cast<int>(npcCount_));
+        writer.append(" total):\n");
+        forEachNpc([&writer](const Npc& npc) {
+            writer.append("  ");
+            writer.writeInfo(npc);
+            writer.append('\n');
+        });
+    }
+    writer.flush();
+    std::cout.flush();
 }
 
 size_t Arena::getNpcCount() const {
-    return npcs_.size();
+    return npcCount_;
 }
 
-void Arena::saveToFile(const std::string& filename) const {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file for writing: " + filename);
+int Arena::getWidth() const {
+    return width_;
+}
+
+int Arena::getHeight() const {
+    return height_;
+}
+
+size_t Arena::writeNpcs(TextSink& sink) const {
+    NpcTextWriter writer(sink);
+    forEachStored([&writer](const Npc& npc) {
+        writer.writeRecord(npc);
+    });
+    writer.flush();
+    return npcCount_;
+}
+
+SaveResult Arena::saveToFile(const std::string& filename) const {
+    TraceSpan span("Arena::saveToFile", "io");
+    span.setArg("npcs", static_cast<std::int64_t>(npcCount_));
+    FileSink file(filename);
+    writeNpcs(file);
+    file.close();
+
+    SaveResult result;
+    result.saved = npcCount_;
+    if (diagnosticsEnabled(DiagLevel::Info)) {
+        diagnose(DiagLevel::Info, "Saved " + std::to_string(result.saved) +
+                                  " NPCs to file: " + filename);
     }
+    return result;
+}
 
-    for (const auto& [name, npc] : npcs_) {
-        file << npc->getType() << " "
-             << npc->getName() << " "
-             << npc->getX() << " "
-             << npc->getY() << std::endl;
+std::vector<BattleResult> Arena::sweepBattleRanges(const std::vector<double>& ranges) const {
+    double maxRange = 0.0;
+    for (double range : ranges) {
+        if (range < 0) {
+            throw std::invalid_argument("Battle range cannot be negative.");
+        }
+        maxRange = std::max(maxRange, range);
     }
-    
-    std::cout << "Saved " << npcs_.size() << " NPCs to file: " << filename << std::endl;
+
+    std::vector<BattleResult> results(ranges.size());
+    if (ranges.empty()) {
+        return results;
+    }
+
+    std::vector<size_t> rangeOrder(ranges.size());
+    for (size_t i = 0; i < rangeOrder.size(); ++i) {
+        rangeOrder[i] = i;
+    }
+    std::sort(rangeOrder.begin(), rangeOrder.end(),
+              [&ranges](size_t a, size_t b) { return ranges[a] < ranges[b]; });
+
+    // Пары до наибольшей дальности раскладываются подсчётом по наименьшей
+    // из запрошенных дальностей, на которой они сражаются
+    BattleSnapshot snapshot = takeBattleSnapshot(maxRange);
+    const auto& points = snapshot.points;
+    std::vector<size_t> bucketOf(snapshot.pairs.size());
+    std::vector<size_t> bucketStart(ranges.size() + 1, 0);
+    for (size_t i = 0; i < snapshot.pairs.size(); ++i) {
+        const CandidatePair& pair = snapshot.pairs[i];
+        int dx = points[pair.first].x - points[pair.second].x;
+        int dy = points[pair.first].y - points[pair.second].y;
+        auto bucket = std::partition_point(rangeOrder.begin(), rangeOrder.end(),
+            [&ranges, dx, dy](size_t index) { return !withinRange(dx, dy, ranges[index]); });
+        bucketOf[i] = static_cast<size_t>(bucket - rangeOrder.begin());
+        bucketStart[bucketOf[i] + 1]++;
+    }
+    for (size_t i = 1; i < bucketStart.size(); ++i) {
+        bucketStart[i] += bucketStart[i - 1];
+    }
+    std::vector<size_t> byRange(snapshot.pairs.size());
+    std::vector<size_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (size_t i = 0; i < snapshot.pairs.size(); ++i) {
+        byRange[fill[bucketOf[i]]++] = i;
+    }
+
+    // С ростом дальности пары только добавляются, а погибшие не воскресают:
+    // множество погибших и число схваток наращиваются от дальности к дальности
+    const NpcRegistry& registry = NpcRegistry::instance();
+    DeathSet deaths(snapshot.kinds.size());
+    size_t deathCount = 0;
+    size_t fights = 0;
+    for (size_t step = 0; step < rangeOrder.size(); ++step) {
+        size_t rangeIndex = rangeOrder[step];
+        for (size_t k = bucketStart[step]; k < bucketStart[step + 1]; ++k) {
+            const CandidatePair& pair = snapshot.pairs[byRange[k]];
+            auto bits = static_cast<unsigned>(registry.outcome(snapshot.kinds[pair.first],
+                                                               snapshot.kinds[pair.second]));
+            if (bits == 0) continue;
+            fights++;
+            if ((bits & 1) && !deaths.contains(pair.second)) {
+                deaths.mark(pair.second);
+                deathCount++;
+            }
+            if ((bits & 2) && !deaths.contains(pair.first)) {
+                deaths.mark(pair.first);
+                deathCount++;
+            }
+        }
+
+        BattleResult& result = results[rangeIndex];
+        result.range = ranges[rangeIndex];
+        result.npcsBefore = snapshot.kinds.size();
+        result.npcsAfter = snapshot.kinds.size() - deathCount;
+        result.fights = fights;
+        result.killed.reserve(deathCount);
+        for (size_t i = 0; i < snapshot.names.size(); ++i) {
+            if (deaths.contains(i)) {
+                result.killed.push_back(*snapshot.names[i]);
+            }
+        }
+        if (storageOrder_ != StorageOrder::Name) {
+            std::sort(result.killed.begin(), result.killed.end());
+        }
+    }
+    return results;
 }
 
-void Arena::loadFromFile(const std::string& filename) {
+LoadResult Arena::loadFromFile(const std::string& filename) {
+    TraceSpan span("Arena::loadFromFile", "io");
     std::ifstream file(filename);
     if (!file.is_open()) {
         throw std::runtime_error("Failed to open file for reading: " + filename);
     }
 
+    LoadResult result;
     std::string line;
-    int loadedCount = 0;
+    size_t lineNumber = 0;
     while (std::getline(file, line)) {
-        if (line.empty()) continue;
+        loadLine(line, ++lineNumber, result);
+    }
+    reportLoaded(result, filename);
+    return result;
+}
+
+void Arena::loadLine(std::string_view line, size_t lineNumber, LoadResult& result) {
+    if (line.empty()) {
+        return;
+    }
 
+    auto npc = NpcFactory::tryCreateFromString(line);
+    NpcError error = npc ? tryAddNpc(std::move(*npc)) : npc.error();
+    if (error.ok()) {
+        result.loaded++;
+        return;
+    }
+
+    result.errors.push_back({lineNumber, error});
+    if (diagnosticsEnabled(DiagLevel::Warning)) {
+        diagnose(DiagLevel::Warning, "Error loading NPC from line: " + std::string(line) +
+                                     " - " + error.message());
+    }
+}
+
+void Arena::reportLoaded(const LoadResult& result, const std::string& filename) const {
+    if (diagnosticsEnabled(DiagLevel::Info)) {
+        diagnose(DiagLevel::Info, "Loaded " + std::to_string(result.loaded) +
+                                  " NPCs from file: " + filename);
+    }
+}
+
+namespace {
+
+const size_t kLoadChunkSize = 1 << 20;
+
+Task<SaveResult> saveSnapshot(Arena snapshot, std::string filename, ThreadPool& executor) {
+    co_await schedule(executor);
+    TraceSpan span("Arena::saveAsync", "io");
+    FileSink file(filename);
+    SaveResult result;
+    result.saved = snapshot.writeNpcs(file);
+    file.close();
+    co_return result;
+}
+
+// Чтение очередного блока файла на исполнителе; 0 - конец файла
+Task<size_t> readChunk(std::ifstream& file, std::vector<char>& buffer, ThreadPool& executor) {
+    co_await schedule(executor);
+    TraceSpan span("readChunk", "io");
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    co_return static_cast<size_t>(file.gcount());
+}
+
+}
+
+Task<SaveResult> Arena::saveAsync(std::string filename, ThreadPool& executor) const {
+    // Форк снимается здесь, до первой приостановки: изменения арены после
+    // вызова в файл не попадают
+    return saveSnapshot(fork(), std::move(filename), executor);
+}
+
+Task<LoadResult> Arena::loadAsync(std::string filename, ThreadPool& executor) {
+    co_await schedule(executor);
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for reading: " + filename);
+    }
+
+    // Два буфера: в один читается следующий блок, другой в это время разбирается
+    std::vector<char> current(kLoadChunkSize);
+    std::vector<char> next(kLoadChunkSize);
+    size_t currentSize = co_await readChunk(file, current, executor);
+
+    LoadResult result;
+    size_t lineNumber = 0;
+    // Строка, разрезанная границей блоков
+    std::string carry;
+    while (currentSize > 0) {
+        Task<size_t> readAhead = readChunk(file, next, executor);
+        readAhead.start();
+
+        std::exception_ptr error;
         try {
-            auto npc = NpcFactory::createFromString(line);
-            addNpc(std::move(npc));
-            loadedCount++;
-        } catch (const std::exception& e) {
-            std::cerr << "Error loading NPC from line: " << line 
-                      << " - " << e.what() << std::endl;
+            TraceSpan span("parseChunk", "io");
+            std::string_view chunk(current.data(), currentSize);
+            size_t lineStart = 0;
+            for (size_t end = chunk.find('\n'); end != std::string_view::npos;
+                 end = chunk.find('\n', lineStart)) {
+                std::string_view line = chunk.substr(lineStart, end - lineStart);
+                if (!carry.empty()) {
+                    carry.append(line);
+                    loadLine(carry, ++lineNumber, result);
+                    carry.clear();
+                } else {
+                    loadLine(line, ++lineNumber, result);
+                }
+                lineStart = end + 1;
+            }
+            carry.append(chunk.substr(lineStart));
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        // Чтение следующего блока дожидается даже при ошибке разбора
+        size_t nextSize = co_await readAhead;
+        if (error) {
+            std::rethrow_exception(error);
         }
+        std::swap(current, next);
+        currentSize = nextSize;
     }
-    
-    std::cout << "Loaded " << loadedCount << " NPCs from file: " << filename << std::endl;
+    if (!carry.empty()) {
+        loadLine(carry, ++lineNumber, result);
+    }
+
+    reportLoaded(result, filename);
+    co_return result;
 }
 
-void Arena::clear() {
-    npcs_.clear();
-    std::cout << "Arena cleared." << std::endl;
+size_t Arena::clear() {
+    size_t removed = npcCount_;
+    // Общую с форками основу не трогаем, а заменяем пустой
+    base_ = std::make_shared<NpcMap>();
+    overlay_.clear();
+    tombstones_.clear();
+    npcCount_ = 0;
+    pending_.clear();
+    removed_.clear();
+    if (storageOrder_ == StorageOrder::Morton) {
+        storage_ = std::make_shared<std::vector<StorageEntry>>();
+    }
+    diagnose(DiagLevel::Info, "Arena cleared.");
+    return removed;
+}
+
+void Arena::setDiagnostics(std::shared_ptr<DiagnosticsSink> sink, DiagLevel minLevel) {
+    if (sink) {
+        diagnostics_ = std::move(sink);
+        diagnosticsLevel_ = minLevel;
+    } else {
+        diagnostics_ = std::make_shared<NullDiagnosticsSink>();
+        diagnosticsLevel_ = DiagLevel::Off;
+    }
+}
+
+bool Arena::diagnosticsEnabled(DiagLevel level) const {
+    return level >= diagnosticsLevel_ && diagnosticsLevel_ != DiagLevel::Off;
+}
+
+void Arena::diagnose(DiagLevel level, const std::string& message) const {
+    if (diagnosticsEnabled(level)) {
+        diagnostics_->write(level, message);
+    }
 }
 
 void Arena::addObserver(std::shared_ptr<Observer> observer) {
@@ -114,66 +568,296 @@ void Arena::removeObserver(std::shared_ptr<Observer> observer) {
     }
 }
 
-void Arena::notifyObservers(const std::string& event) {
+void Arena::setEventBatchSize(size_t batchSize) {
+    flushEvents();
+    eventBatchSize_ = batchSize;
+}
+
+size_t Arena::getEventBatchSize() const {
+    return eventBatchSize_;
+}
+
+void Arena::bufferEvent(const FightEvent& fight) {
+    // Строки буфера переиспользуются между пачками и боями
+    if (eventCount_ == eventBuffer_.size()) {
+        eventBuffer_.emplace_back();
+        fightBuffer_.emplace_back();
+    }
+    fightBuffer_[eventCount_] = fight;
+    Event& event = eventBuffer_[eventCount_++];
+
+    auto describe = [&](std::string_view name, NpcKind kind) {
+        event += name;
+        event += " (";
+        event += kindName(kind);
+        event += ")";
+    };
+    event.clear();
+    describe(fight.first, fight.firstKind);
+    event += fight.mutual ? " and " : " killed ";
+    describe(fight.second, fight.secondKind);
+    if (fight.mutual) {
+        event += " killed each other";
+    }
+}
+
+void Arena::flushEvents() {
+    if (eventCount_ == 0) {
+        return;
+    }
+    TraceSpan span("observers", "dispatch");
+    span.setArg("events", static_cast<std::int64_t>(eventCount_));
+    std::span<const Event> batch(eventBuffer_.data(), eventCount_);
+    std::span<const FightEvent> fights(fightBuffer_.data(), eventCount_);
+    eventCount_ = 0;
     for (auto& observer : observers_) {
-        observer->notify(event);
+        observer->notifyBatch(batch);
+        observer->notifyFights(fights);
     }
 }
 
-void Arena::startBattle(double range) {
+Arena::BattleSnapshot Arena::takeBattleSnapshot(double range) const {
+    // Исходы по паре видов: пары видов, которые не нападают друг на друга
+    // (в том числе одинаковых), не перебираются вовсе
+    const NpcRegistry& registry = NpcRegistry::instance();
+    KindPairFilter hostilePairs;
+    for (size_t a = 0; a < kNpcKindCount; ++a) {
+        for (size_t b = 0; b < kNpcKindCount; ++b) {
+            hostilePairs.allowed[a][b] = registry.outcome(static_cast<NpcKind>(a),
+                                                          static_cast<NpcKind>(b)) != PairOutcome::None;
+        }
+    }
+
+    BattleSnapshot snapshot;
+    snapshot.kinds.reserve(npcCount_);
+    snapshot.names.reserve(npcCount_);
+    snapshot.points.reserve(npcCount_);
+    forEachStored([&snapshot](const Npc& npc) {
+        snapshot.points.push_back({npc.getX(), npc.getY(), snapshot.kinds.size(),
+                                   static_cast<std::uint8_t>(npc.getKind())});
+        snapshot.kinds.push_back(npc.getKind());
+        snapshot.names.push_back(&npc.getName());
+    });
+
+    // Индекс на каждый вид: перебираются только пары враждебных видов
+    KindPartitionedIndex index;
+    index.build(spatialBackend_, snapshot.points, range);
+    snapshot.search = index.collectPairsWithin(range, hostilePairs, snapshot.pairs);
+    return snapshot;
+}
+
+BattleResult Arena::startBattle(double range) {
     if (range < 0) {
         throw std::invalid_argument("Battle range cannot be negative.");
     }
+    TraceSpan battleSpan("Arena::startBattle", "battle");
+    battleSpan.setArg("npcs", static_cast<std::int64_t>(npcCount_));
     
-    CombatVisitor visitor;
-    std::vector<std::string> toRemove;
     int battlesCount = 0;
 
-    std::cout << "Starting battle with range: " << range << std::endl;
-    std::cout << "NPCs before battle: " << npcs_.size() << std::endl;
-
-    for (auto& [name1, npc1] : npcs_) {
-        for (auto& [name2, npc2] : npcs_) {
-            if (name1 == name2) continue;
-            if (name1 > name2) continue;
-
-            double distance = npc1->distanceTo(*npc2);
-            if (distance > range) continue;
-            
-            bool npc1KillsNpc2 = visitor.canKill(npc1.get(), npc2.get());
-            bool npc2KillsNpc1 = visitor.canKill(npc2.get(), npc1.get());
-            
-            if (npc1KillsNpc2 && npc2KillsNpc1) {
-                std::string event = npc1->getName() + " (" + npc1->getType() + 
-                                   ") and " + npc2->getName() + " (" + npc2->getType() + 
-                                   ") killed each other";
-                notifyObservers(event);
-                toRemove.push_back(name1);
-                toRemove.push_back(name2);
-                battlesCount++;
-            } else if (npc1KillsNpc2) {
-                std::string event = npc1->getName() + " (" + npc1->getType() + 
-                                   ") killed " + npc2->getName() + " (" + npc2->getType() + ")";
-                notifyObservers(event);
-                toRemove.push_back(name2);
-                battlesCount++;
-            } else if (npc2KillsNpc1) {
-                std::string event = npc2->getName() + " (" + npc2->getType() + 
-                                   ") killed " + npc1->getName() + " (" + npc1->getType() + ")";
-                notifyObservers(event);
-                toRemove.push_back(name1);
-                battlesCount++;
+    BattleStats stats;
+    std::uint64_t allocationsBefore = allocationCount();
+    // Аппаратные счётчики открываются на время боя в текущем потоке
+    std::optional<PerfCounters> perfCounters;
+    PerfCounters* counters = nullptr;
+#if ARENA_ENABLE_STATS
+    stats.range = range;
+    stats.npcsBefore = npcCount_;
+    if (hardwareCounters_) {
+        counters = &perfCounters.emplace();
+        stats.countersTracked = true;
+    }
+#endif
+
+    BattleResult result;
+    result.range = range;
+    result.npcsBefore = npcCount_;
+
+    if (diagnosticsEnabled(DiagLevel::Info)) {
+        std::ostringstream message;
+        message << "Starting battle with range: " << range
+                << "\nNPCs before battle: " << npcCount_;
+        diagnose(DiagLevel::Info, message.str());
+    }
+
+    // Бой проходит в две фазы: все пары оцениваются по замороженному снимку
+    // (имена и виды NPC в порядке имён), затем погибшие удаляются разом.
+    // Погибшие отмечаются в DeathSet, поэтому исход не зависит от порядка
+    // обработки пар, а убитый в этом бою NPC продолжает сражаться до конца боя.
+    const NpcRegistry& registry = NpcRegistry::instance();
+    BattleSnapshot snapshot;
+    {
+        TraceSpan span("candidates", "battle");
+        PhaseTimer timer(stats.candidateNs, counters, &stats.candidateCounters);
+        snapshot = takeBattleSnapshot(range);
+#if ARENA_ENABLE_STATS
+        stats.backend = spatialBackendName(snapshot.search.backend);
+        stats.pairsConsidered = snapshot.search.distanceChecks;
+        stats.pairsInRange = snapshot.pairs.size();
+#endif
+    }
+    const std::vector<NpcKind>& kinds = snapshot.kinds;
+    const std::vector<const std::string*>& names = snapshot.names;
+    const std::vector<CandidatePair>& pairs = snapshot.pairs;
+
+    // Фаза оценки: читает только снимок, пары независимы друг от друга
+    std::vector<PairOutcome> outcomes(pairs.size(), PairOutcome::None);
+    DeathSet deaths(kinds.size());
+    {
+        TraceSpan span("combat", "battle");
+        PhaseTimer timer(stats.combatNs, counters, &stats.combatCounters);
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            PairOutcome outcome = registry.outcome(kinds[pairs[i].first], kinds[pairs[i].second]);
+            auto bits = static_cast<unsigned>(outcome);
+            if (bits & 1) deaths.mark(pairs[i].second);
+            if (bits & 2) deaths.mark(pairs[i].first);
+            outcomes[i] = outcome;
+        }
+    }
+
+    {
+        TraceSpan span("dispatch", "battle");
+        PhaseTimer timer(stats.dispatchNs, counters, &stats.dispatchCounters);
+        // Без наблюдателей события не формируются
+        bool notifying = !observers_.empty();
+        if (notifying) {
+            for (auto& observer : observers_) {
+                observer->battleStarted(range);
+            }
+        }
+
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            size_t first = pairs[i].first;
+            size_t second = pairs[i].second;
+            if (outcomes[i] == PairOutcome::None) {
+                continue;
+            }
+            battlesCount++;
+
+            if (notifying) {
+                // Победитель - первым; при взаимном убийстве порядок пары
+                FightEvent fight;
+                bool secondWins = outcomes[i] == PairOutcome::SecondKills;
+                size_t winner = secondWins ? second : first;
+                size_t loser = secondWins ? first : second;
+                fight.first = *names[winner];
+                fight.second = *names[loser];
+                fight.firstKind = kinds[winner];
+                fight.secondKind = kinds[loser];
+                fight.mutual = outcomes[i] == PairOutcome::Mutual;
+                bufferEvent(fight);
+                if (eventCount_ == eventBatchSize_) {
+                    flushEvents();
+                }
+            }
+
+#if ARENA_ENABLE_STATS
+            auto kind1 = static_cast<size_t>(kinds[first]);
+            auto kind2 = static_cast<size_t>(kinds[second]);
+            auto bits = static_cast<unsigned>(outcomes[i]);
+            if (bits & 1) stats.kills[kind1][kind2]++;
+            if (bits & 2) stats.kills[kind2][kind1]++;
+#endif
+        }
+        // Остаток событий доставляется в конце боя
+        if (notifying) {
+            flushEvents();
+            for (auto& observer : observers_) {
+                observer->battleFinished();
             }
         }
     }
-    
-    std::sort(toRemove.begin(), toRemove.end());
-    toRemove.erase(std::unique(toRemove.begin(), toRemove.end()), toRemove.end());
-    
-    for (const auto& name : toRemove) {
-        npcs_.erase(name);
+
+    // Фаза применения: один проход по карте в том же порядке, что и снимок;
+    // имена погибших получаются уже упорядоченными и без повторов
+    std::vector<std::string> killed;
+    if (deaths.count() > 0 && storageOrder_ == StorageOrder::Name) {
+        TraceSpan span("removal", "battle");
+        PhaseTimer timer(stats.removalNs, counters, &stats.removalCounters);
+        killed.reserve(deaths.count());
+        if (NpcMap* base = exclusiveBase()) {
+            size_t index = 0;
+            for (auto it = base->begin(); it != base->end(); ++index) {
+                if (deaths.contains(index)) {
+                    killed.push_back(it->first);
+                    it = base->erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            npcCount_ -= killed.size();
+        } else {
+            for (size_t i = 0; i < names.size(); ++i) {
+                if (deaths.contains(i)) {
+                    killed.push_back(*names[i]);
+                }
+            }
+            eraseEntries(killed);
+        }
+    } else if (deaths.count() > 0) {
+        // Снимок снят в порядке хранения: его номера совпадают с позициями обхода
+        TraceSpan span("removal", "battle");
+        PhaseTimer timer(stats.removalNs, counters, &stats.removalCounters);
+        killed.reserve(deaths.count());
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (deaths.contains(i)) {
+                killed.push_back(*names[i]);
+            }
+        }
+        // Выжившие образуют новый собственный список; общий с форками не меняется
+        auto survivors = std::make_shared<std::vector<StorageEntry>>();
+        survivors->reserve(names.size() - killed.size());
+        size_t index = 0;
+        forEachStored([&survivors, &deaths, &index](const Npc& npc) {
+            if (!deaths.contains(index++)) {
+                survivors->push_back({storageKey(npc), &npc});
+            }
+        });
+        storage_ = std::move(survivors);
+        pending_.clear();
+        removed_.clear();
+        // Удаление в порядке имён: соседние поиски проходят по одним и тем же узлам
+        std::sort(killed.begin(), killed.end());
+        eraseEntries(killed);
     }
-    
-    std::cout << "Battle finished. Fights: " << battlesCount 
-              << ", NPCs after battle: " << npcs_.size() << std::endl;
+
+#if ARENA_ENABLE_STATS
+    stats.fights = battlesCount;
+    stats.npcsAfter = npcCount_;
+    stats.allocationsTracked = allocationCountingEnabled();
+    stats.allocations = allocationCount() - allocationsBefore;
+    lastBattleStats_ = stats;
+#else
+    (void)allocationsBefore;
+#endif
+
+    result.npcsAfter = npcCount_;
+    result.fights = battlesCount;
+    result.killed = std::move(killed);
+
+    if (diagnosticsEnabled(DiagLevel::Info)) {
+        diagnose(DiagLevel::Info, "Battle finished. Fights: " + std::to_string(battlesCount) +
+                                  ", NPCs after battle: " + std::to_string(npcCount_));
+    }
+    return result;
+}
+
+const BattleStats& Arena::getLastBattleStats() const {
+    return lastBattleStats_;
+}
+
+void Arena::setSpatialBackend(SpatialBackend backend) {
+    spatialBackend_ = backend;
+}
+
+void Arena::setHardwareCountersEnabled(bool enabled) {
+    hardwareCounters_ = enabled;
+}
+
+bool Arena::getHardwareCountersEnabled() const {
+    return hardwareCounters_;
+}
+
+SpatialBackend Arena::getSpatialBackend() const {
+    return spatialBackend_;
 }
\ No newline at end of file
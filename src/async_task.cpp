@@ -0,0 +1,7 @@
+#include "../include/async_task.h"
+
+ThreadPool& defaultIoExecutor() {
+    // Два потока: чтение следующего блока файла идёт параллельно с разбором
+    static ThreadPool pool(2);
+    return pool;
+}
@@ -0,0 +1,205 @@
+#include "../include/batch_runner.h"
+#include "../include/arena.h"
+#include "../include/factory.h"
+#include "../include/thread_pool.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+struct LayoutEntry {
+    std::string type;
+    std::string name;
+    int x = 0;
+    int y = 0;
+};
+
+// Состояние рабочего потока, переживающее отдельные прогоны. Между
+// прогонами переиспользуются записи расстановки (вместе с ёмкостью строк
+// типа и имени) и буфер строки файла; NPC арены создаются заново
+struct WorkerState {
+    Arena arena;
+    std::vector<LayoutEntry> layout;
+    size_t layoutSize = 0;
+    std::string line;
+    std::map<double, RangeSummary> totals;
+    size_t failedJobs = 0;
+};
+
+LayoutEntry& nextEntry(WorkerState& state) {
+    if (state.layoutSize == state.layout.size()) {
+        state.layout.emplace_back();
+    }
+    return state.layout[state.layoutSize++];
+}
+
+void generateLayout(WorkerState& state, unsigned seed, size_t npcCount) {
+    static const char* kTypes[] = {"Dragon", "Elf", "Druid"};
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> coord(0, MAX_WIDTH);
+    std::uniform_int_distribution<int> kind(0, 2);
+
+    state.layoutSize = 0;
+    for (size_t i = 0; i < npcCount; ++i) {
+        LayoutEntry& entry = nextEntry(state);
+        entry.type.assign(kTypes[kind(rng)]);
+        entry.name.assign("Npc");
+        entry.name.append(std::to_string(i));
+        entry.x = coord(rng);
+        entry.y = coord(rng);
+    }
+}
+
+// Строки файла разбираются прямо в расстановку, без промежуточной арены;
+// неразборчивые строки пропускаются, как в Arena::loadFromFile
+void loadLayout(WorkerState& state, const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for reading: " + filename);
+    }
+
+    state.layoutSize = 0;
+    ParsedNpcLine parsed;
+    while (std::getline(file, state.line)) {
+        if (!NpcFactory::parseLine(state.line, parsed).ok()) {
+            continue;
+        }
+        LayoutEntry& entry = nextEntry(state);
+        entry.type.assign(parsed.type);
+        entry.name.assign(parsed.name);
+        entry.x = parsed.x;
+        entry.y = parsed.y;
+    }
+}
+
+void runJob(WorkerState& state, const BatchJob& job) {
+    if (job.sourceFile.empty()) {
+        generateLayout(state, job.seed, job.npcCount);
+    } else {
+        loadLayout(state, job.sourceFile);
+    }
+
+    // Неизвестный тип или повторное имя пропускаются, как при загрузке файла
+    state.arena.clear();
+    for (size_t i = 0; i < state.layoutSize; ++i) {
+        const LayoutEntry& entry = state.layout[i];
+        auto npc = NpcFactory::tryCreateNpc(entry.type, entry.name, entry.x, entry.y);
+        if (npc) {
+            state.arena.tryAddNpc(std::move(*npc));
+        }
+    }
+
+    // Все дальности за один проход по одной и той же расстановке
+    std::vector<BattleResult> results = state.arena.sweepBattleRanges(job.ranges);
+    for (const BattleResult& result : results) {
+        RangeSummary& summary = state.totals[result.range];
+        summary.range = result.range;
+        summary.battles++;
+        summary.fights += result.fights;
+
+        // Имена погибших упорядочены так же, как обход арены
+        size_t next = 0;
+        state.arena.forEachNpc([&summary, &result, &next](const Npc& npc) {
+            KindSurvival& survival = summary.kinds[static_cast<size_t>(npc.getKind())];
+            survival.initial++;
+            if (next < result.killed.size() && result.killed[next] == npc.getName()) {
+                next++;
+            } else {
+                survival.survived++;
+            }
+        });
+    }
+}
+
+}
+
+double KindSurvival::rate() const {
+    return initial == 0 ? 0.0 : static_cast<double>(survived) / initial;
+}
+
+void BatchSummary::print(std::ostream& os) const {
+    os << "Jobs: " << jobs << " (failed: " << failedJobs << "), threads: " << threads
+       << ", time: " << std::fixed << std::setprecision(1) << elapsedMs << " ms\n";
+    for (const auto& summary : ranges) {
+        os << "Range " << std::setprecision(1) << summary.range
+           << ": battles " << summary.battles << ", fights " << summary.fights << "\n";
+        for (size_t kind = 0; kind < kNpcKindCount; ++kind) {
+            const KindSurvival& survival = summary.kinds[kind];
+            if (survival.initial == 0) continue;
+            os << "  " << std::setw(8) << kindName(static_cast<NpcKind>(kind))
+               << ": " << survival.survived << "/" << survival.initial
+               << " survived (" << std::setprecision(1) << survival.rate() * 100.0 << "%)\n";
+        }
+    }
+}
+
+BatchRunner::BatchRunner(size_t threadCount) : threadCount_(threadCount) {
+    if (threadCount_ == 0) {
+        threadCount_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+BatchSummary BatchRunner::run(const std::vector<BatchJob>& jobs) const {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<WorkerState> workers(threadCount_);
+    {
+        ThreadPool pool(threadCount_);
+        for (const auto& job : jobs) {
+            pool.submit([&workers, &job] {
+                WorkerState& state = workers[ThreadPool::currentWorker()];
+                try {
+                    runJob(state, job);
+                } catch (const std::exception&) {
+                    state.failedJobs++;
+                }
+            });
+        }
+        pool.waitIdle();
+    }
+
+    // Объединение итогов рабочих потоков
+    std::map<double, RangeSummary> merged;
+    BatchSummary summary;
+    for (const auto& state : workers) {
+        summary.failedJobs += state.failedJobs;
+        for (const auto& [range, partial] : state.totals) {
+            RangeSummary& total = merged[range];
+            total.range = range;
+            total.battles += partial.battles;
+            total.fights += partial.fights;
+            for (size_t kind = 0; kind < kNpcKindCount; ++kind) {
+                total.kinds[kind].initial += partial.kinds[kind].initial;
+                total.kinds[kind].survived += partial.kinds[kind].survived;
+            }
+        }
+    }
+
+    summary.jobs = jobs.size();
+    summary.threads = threadCount_;
+    for (const auto& [range, total] : merged) {
+        summary.ranges.push_back(total);
+    }
+    summary.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return summary;
+}
+
+std::vector<BatchJob> BatchRunner::generateJobs(size_t count,
+                                                size_t npcCount,
+                                                const std::vector<double>& ranges,
+                                                unsigned seed) {
+    std::vector<BatchJob> jobs(count);
+    for (size_t i = 0; i < count; ++i) {
+        jobs[i].seed = seed + static_cast<unsigned>(i);
+        jobs[i].npcCount = npcCount;
+        jobs[i].ranges = ranges;
+    }
+    return jobs;
+}
@@ -0,0 +1,384 @@
+#include "../include/battle_log.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if !defined(__unix__) && !defined(__APPLE__)
+#error "The battle log needs POSIX mmap; configure with -DARENA_ENABLE_BATTLE_LOG=OFF"
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char kMagic[8] = {'N', 'P', 'C', 'B', 'L', 'O', 'G', '1'};
+const std::uint32_t kVersion = 1;
+const size_t kInitialCapacity = 1 << 20;
+
+// Выравнивание секций по 8 байт для полей double и uint64_t
+size_t alignTo8(size_t offset) {
+    return (offset + 7) & ~size_t(7);
+}
+
+std::runtime_error systemError(const std::string& what, const std::string& filename) {
+    return std::runtime_error(what + " " + filename + ": " + std::strerror(errno));
+}
+
+}
+
+BattleLogObserver::BattleLogObserver(const std::string& filename) : filename_(filename) {
+    fd_ = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        throw systemError("Cannot open battle log", filename);
+    }
+    try {
+        reserve(kInitialCapacity);
+    } catch (...) {
+        ::close(fd_);
+        throw;
+    }
+    size_ = sizeof(BattleLogHeader);
+    updateHeader(false);
+}
+
+BattleLogObserver::~BattleLogObserver() {
+    try {
+        close();
+    } catch (...) {
+        // Ошибки закрытия в деструкторе не пробрасываются
+    }
+}
+
+void BattleLogObserver::notify(const std::string&) {
+    // Текст события не нужен: журнал строится по notifyFights
+}
+
+void BattleLogObserver::battleStarted(double range) {
+    if (fd_ < 0) {
+        throw std::logic_error("Battle log is closed: " + filename_);
+    }
+    if (inBattle_) {
+        battleFinished();
+    }
+    battles_.push_back({range, recordCount_, 0});
+    inBattle_ = true;
+}
+
+void BattleLogObserver::notifyFights(std::span<const FightEvent> fights) {
+    if (!inBattle_) {
+        battleStarted(0);
+    }
+    reserve(fights.size() * sizeof(BattleLogRecord));
+
+    BattleLogRecord record{};
+    record.battle = static_cast<std::uint32_t>(battles_.size() - 1);
+    for (const FightEvent& fight : fights) {
+        record.first = names_.intern(fight.first);
+        record.second = names_.intern(fight.second);
+        record.firstKind = fight.firstKind;
+        record.secondKind = fight.secondKind;
+        record.mutual = fight.mutual ? 1 : 0;
+        append(&record, sizeof(record));
+    }
+    recordCount_ += fights.size();
+}
+
+void BattleLogObserver::battleFinished() {
+    if (!inBattle_) {
+        return;
+    }
+    BattleLogBattle& battle = battles_.back();
+    battle.recordCount = recordCount_ - battle.firstRecord;
+    inBattle_ = false;
+    // Число событий в заголовке позволяет разобрать незакрытый журнал
+    updateHeader(false);
+}
+
+void BattleLogObserver::close() {
+    if (fd_ < 0) {
+        return;
+    }
+    if (data_ == nullptr) {
+        ::close(fd_);
+        fd_ = -1;
+        return;
+    }
+    try {
+        writeIndexes();
+    } catch (...) {
+        // Журнал остаётся незакрытым (finished = 0) и читателем не принимается
+        ::munmap(data_, capacity_);
+        data_ = nullptr;
+        ::close(fd_);
+        fd_ = -1;
+        throw;
+    }
+
+    ::munmap(data_, capacity_);
+    data_ = nullptr;
+    int truncated = ::ftruncate(fd_, static_cast<off_t>(size_));
+    int closed = ::close(fd_);
+    fd_ = -1;
+    if (truncated != 0 || closed != 0) {
+        throw systemError("Cannot finish battle log", filename_);
+    }
+}
+
+void BattleLogObserver::writeIndexes() {
+    battleFinished();
+
+    // Индекс по NPC: каждое событие попадает в него дважды. Записи уже
+    // упорядочены, поэтому сортировка подсчётом по номеру имени сохраняет
+    // порядок событий внутри одного NPC.
+    const auto* records = reinterpret_cast<const BattleLogRecord*>(data_ + sizeof(BattleLogHeader));
+    std::vector<std::uint64_t> starts(names_.size() + 1, 0);
+    for (size_t i = 0; i < recordCount_; ++i) {
+        starts[records[i].first + 1]++;
+        starts[records[i].second + 1]++;
+    }
+    for (size_t id = 0; id < names_.size(); ++id) {
+        starts[id + 1] += starts[id];
+    }
+    std::vector<BattleLogNpcEntry> npcIndex(recordCount_ * 2);
+    for (size_t i = 0; i < recordCount_; ++i) {
+        for (std::uint32_t id : {records[i].first, records[i].second}) {
+            npcIndex[starts[id]++] = {id, 0, i};
+        }
+    }
+
+    // Таблица имён: смещения, символы и номера в алфавитном порядке
+    auto nameCount = static_cast<std::uint32_t>(names_.size());
+    std::vector<std::uint32_t> nameOffsets(nameCount + 1, 0);
+    for (std::uint32_t id = 0; id < nameCount; ++id) {
+        nameOffsets[id + 1] = nameOffsets[id] + static_cast<std::uint32_t>(names_.name(id).size());
+    }
+    std::vector<std::uint32_t> sortedNames(nameCount);
+    for (std::uint32_t id = 0; id < nameCount; ++id) {
+        sortedNames[id] = id;
+    }
+    std::sort(sortedNames.begin(), sortedNames.end(), [&](std::uint32_t a, std::uint32_t b) {
+        return names_.name(a) < names_.name(b);
+    });
+
+    size_t namesOffset = size_;
+    append(nameOffsets.data(), nameOffsets.size() * sizeof(std::uint32_t));
+    for (std::uint32_t id = 0; id < nameCount; ++id) {
+        std::string_view name = names_.name(id);
+        append(name.data(), name.size());
+    }
+    size_ = (size_ + 3) & ~size_t(3);
+    append(sortedNames.data(), sortedNames.size() * sizeof(std::uint32_t));
+
+    reserve(8);
+    size_ = alignTo8(size_);
+    size_t battlesOffset = size_;
+    append(battles_.data(), battles_.size() * sizeof(BattleLogBattle));
+    size_t npcIndexOffset = size_;
+    append(npcIndex.data(), npcIndex.size() * sizeof(BattleLogNpcEntry));
+
+    updateHeader(true);
+    auto* header = reinterpret_cast<BattleLogHeader*>(data_);
+    header->nameCount = nameCount;
+    header->npcEntryCount = npcIndex.size();
+    header->namesOffset = namesOffset;
+    header->battlesOffset = battlesOffset;
+    header->npcIndexOffset = npcIndexOffset;
+}
+
+size_t BattleLogObserver::getRecordCount() const {
+    return recordCount_;
+}
+
+void BattleLogObserver::reserve(size_t bytes) {
+    if (size_ + bytes <= capacity_) {
+        return;
+    }
+    size_t capacity = std::max(capacity_ * 2, size_ + bytes);
+    // Прежнее отображение снимается только после успешного нового: при
+    // ошибке журнал остаётся целым и может быть закрыт
+    if (::ftruncate(fd_, static_cast<off_t>(capacity)) != 0) {
+        throw systemError("Cannot grow battle log", filename_);
+    }
+    void* mapped = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapped == MAP_FAILED) {
+        throw systemError("Cannot map battle log", filename_);
+    }
+    if (data_ != nullptr) {
+        ::munmap(data_, capacity_);
+    }
+    data_ = static_cast<char*>(mapped);
+    capacity_ = capacity;
+}
+
+void BattleLogObserver::append(const void* bytes, size_t length) {
+    reserve(length);
+    if (length > 0) {
+        std::memcpy(data_ + size_, bytes, length);
+    }
+    size_ += length;
+}
+
+void BattleLogObserver::updateHeader(bool finished) {
+    auto* header = reinterpret_cast<BattleLogHeader*>(data_);
+    std::memcpy(header->magic, kMagic, sizeof(kMagic));
+    header->version = kVersion;
+    header->finished = finished ? 1 : 0;
+    header->recordCount = recordCount_;
+    header->battleCount = battles_.size();
+}
+
+BattleLogReader::BattleLogReader(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw systemError("Cannot open battle log", filename);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw systemError("Cannot stat battle log", filename);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ < sizeof(BattleLogHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Not a battle log: " + filename);
+    }
+    void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw systemError("Cannot map battle log", filename);
+    }
+    data_ = static_cast<const char*>(mapped);
+
+    header_ = reinterpret_cast<const BattleLogHeader*>(data_);
+    if (std::memcmp(header_->magic, kMagic, sizeof(kMagic)) != 0 || header_->version != kVersion) {
+        ::munmap(const_cast<char*>(data_), size_);
+        throw std::runtime_error("Not a battle log: " + filename);
+    }
+    if (!header_->finished) {
+        ::munmap(const_cast<char*>(data_), size_);
+        throw std::runtime_error("Battle log was not closed: " + filename);
+    }
+
+    // Каждая секция должна целиком лежать в файле
+    auto fits = [&](std::uint64_t offset, std::uint64_t count, size_t itemSize) {
+        return offset <= size_ && count <= (size_ - offset) / itemSize;
+    };
+    size_t namesEnd = header_->namesOffset + (header_->nameCount + 1) * sizeof(std::uint32_t);
+    bool valid = header_->nameCount < NameTable::kNoName &&
+                 fits(sizeof(BattleLogHeader), header_->recordCount, sizeof(BattleLogRecord)) &&
+                 fits(header_->namesOffset, header_->nameCount + 1, sizeof(std::uint32_t)) &&
+                 fits(header_->battlesOffset, header_->battleCount, sizeof(BattleLogBattle)) &&
+                 fits(header_->npcIndexOffset, header_->npcEntryCount, sizeof(BattleLogNpcEntry));
+    if (valid) {
+        nameOffsets_ = reinterpret_cast<const std::uint32_t*>(data_ + header_->namesOffset);
+        size_t charsEnd = namesEnd + nameOffsets_[header_->nameCount];
+        size_t sortedOffset = (charsEnd + 3) & ~size_t(3);
+        valid = fits(sortedOffset, header_->nameCount, sizeof(std::uint32_t));
+        nameChars_ = data_ + namesEnd;
+        sortedNames_ = reinterpret_cast<const std::uint32_t*>(data_ + sortedOffset);
+    }
+    records_ = reinterpret_cast<const BattleLogRecord*>(data_ + sizeof(BattleLogHeader));
+    battles_ = reinterpret_cast<const BattleLogBattle*>(data_ + header_->battlesOffset);
+    npcIndex_ = reinterpret_cast<const BattleLogNpcEntry*>(data_ + header_->npcIndexOffset);
+    if (!valid || !referencesValid()) {
+        ::munmap(const_cast<char*>(data_), size_);
+        throw std::runtime_error("Corrupted battle log: " + filename);
+    }
+}
+
+bool BattleLogReader::referencesValid() const {
+    // Ссылки между секциями проверяются один раз, чтобы доступ по ним не выходил за файл
+    std::uint64_t nameCount = header_->nameCount;
+    std::uint64_t recordCount = header_->recordCount;
+    for (std::uint64_t i = 0; i < nameCount; ++i) {
+        if (nameOffsets_[i] > nameOffsets_[i + 1] || sortedNames_[i] >= nameCount) {
+            return false;
+        }
+    }
+    for (std::uint64_t i = 0; i < header_->battleCount; ++i) {
+        if (battles_[i].recordCount > recordCount ||
+            battles_[i].firstRecord > recordCount - battles_[i].recordCount) {
+            return false;
+        }
+    }
+    for (std::uint64_t i = 0; i < header_->npcEntryCount; ++i) {
+        if (npcIndex_[i].record >= recordCount || npcIndex_[i].name >= nameCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+BattleLogReader::~BattleLogReader() {
+    ::munmap(const_cast<char*>(data_), size_);
+}
+
+size_t BattleLogReader::getBattleCount() const {
+    return header_->battleCount;
+}
+
+size_t BattleLogReader::getRecordCount() const {
+    return header_->recordCount;
+}
+
+const BattleLogBattle& BattleLogReader::battle(size_t index) const {
+    if (index >= header_->battleCount) {
+        throw std::out_of_range("No battle " + std::to_string(index) + " in battle log");
+    }
+    return battles_[index];
+}
+
+std::span<const BattleLogRecord> BattleLogReader::battleRecords(size_t index) const {
+    const BattleLogBattle& info = battle(index);
+    return {records_ + info.firstRecord, info.recordCount};
+}
+
+size_t BattleLogReader::battleOfRecord(size_t record) const {
+    if (record >= header_->recordCount) {
+        throw std::out_of_range("No record " + std::to_string(record) + " in battle log");
+    }
+    // Первый бой, который заканчивается после события; пустые бои пропускаются
+    const BattleLogBattle* end = battles_ + header_->battleCount;
+    const BattleLogBattle* found = std::partition_point(battles_, end, [&](const BattleLogBattle& b) {
+        return b.firstRecord + b.recordCount <= record;
+    });
+    return static_cast<size_t>(found - battles_);
+}
+
+std::vector<BattleLogRecord> BattleLogReader::npcRecords(std::string_view name) const {
+    std::vector<BattleLogRecord> result;
+    std::uint32_t id = findName(name);
+    if (id == NameTable::kNoName) {
+        return result;
+    }
+    const BattleLogNpcEntry* end = npcIndex_ + header_->npcEntryCount;
+    const BattleLogNpcEntry* first = std::partition_point(npcIndex_, end, [&](const BattleLogNpcEntry& e) {
+        return e.name < id;
+    });
+    for (const BattleLogNpcEntry* entry = first; entry != end && entry->name == id; ++entry) {
+        result.push_back(records_[entry->record]);
+    }
+    return result;
+}
+
+std::string_view BattleLogReader::name(std::uint32_t id) const {
+    if (id >= header_->nameCount) {
+        throw std::out_of_range("No name " + std::to_string(id) + " in battle log");
+    }
+    return std::string_view(nameChars_ + nameOffsets_[id], nameOffsets_[id + 1] - nameOffsets_[id]);
+}
+
+std::uint32_t BattleLogReader::findName(std::string_view name) const {
+    const std::uint32_t* end = sortedNames_ + header_->nameCount;
+    const std::uint32_t* found = std::partition_point(sortedNames_, end, [&](std::uint32_t id) {
+        return this->name(id) < name;
+    });
+    if (found != end && this->name(*found) == name) {
+        return *found;
+    }
+    return NameTable::kNoName;
+}
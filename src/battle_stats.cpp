@@ -0,0 +1,92 @@
+#include "../include/battle_stats.h"
+#include <cmath>
+#include <iterator>
+#include <sstream>
+#include <utility>
+
+size_t BattleStats::totalKills() const {
+    size_t total = 0;
+    for (const auto& row : kills) {
+        for (size_t count : row) {
+            total += count;
+        }
+    }
+    return total;
+}
+
+void BattleStats::writeJson(std::ostream& os) const {
+    // Дальность может быть бесконечной (бой всех со всеми), а в JSON нет
+    // inf и nan: такие значения пишутся как null
+    os << "{\"range\":";
+    if (std::isfinite(range)) {
+        os << range;
+    } else {
+        os << "null";
+    }
+    os << ",\"backend\":\"" << backend << "\""
+       << ",\"npcsBefore\":" << npcsBefore
+       << ",\"npcsAfter\":" << npcsAfter
+       << ",\"pairsConsidered\":" << pairsConsidered
+       << ",\"pairsInRange\":" << pairsInRange
+       << ",\"fights\":" << fights
+       << ",\"kills\":{";
+
+    bool first = true;
+    for (size_t a = 0; a < kNpcKindCount; ++a) {
+        for (size_t d = 0; d < kNpcKindCount; ++d) {
+            if (kills[a][d] == 0) continue;
+            if (!first) os << ",";
+            first = false;
+            os << "\"" << kindName(static_cast<NpcKind>(a)) << ">"
+               << kindName(static_cast<NpcKind>(d)) << "\":" << kills[a][d];
+        }
+    }
+
+    os << "},\"phasesNs\":{"
+       << "\"candidates\":" << candidateNs
+       << ",\"combat\":" << combatNs
+       << ",\"dispatch\":" << dispatchNs
+       << ",\"removal\":" << removalNs
+       << "}";
+
+    if (countersTracked) {
+        const std::pair<const char*, const PhaseCounters*> phases[] = {
+            {"candidates", &candidateCounters},
+            {"combat", &combatCounters},
+            {"dispatch", &dispatchCounters},
+            {"removal", &removalCounters}
+        };
+        os << ",\"counters\":{";
+        for (size_t p = 0; p < std::size(phases); ++p) {
+            if (p > 0) os << ",";
+            os << "\"" << phases[p].first << "\":{";
+            for (size_t c = 0; c < kHardwareCounterCount; ++c) {
+                auto counter = static_cast<HardwareCounter>(c);
+                if (c > 0) os << ",";
+                os << "\"" << hardwareCounterName(counter) << "\":";
+                if (phases[p].second->has(counter)) {
+                    os << phases[p].second->get(counter);
+                } else {
+                    os << "null";
+                }
+            }
+            os << "}";
+        }
+        os << "}";
+    } else {
+        os << ",\"counters\":null";
+    }
+
+    if (allocationsTracked) {
+        os << ",\"allocations\":" << allocations;
+    } else {
+        os << ",\"allocations\":null";
+    }
+    os << "}";
+}
+
+std::string BattleStats::toJson() const {
+    std::ostringstream os;
+    writeJson(os);
+    return os.str();
+}
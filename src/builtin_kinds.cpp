@@ -0,0 +1,20 @@
+#include "../include/npc_registry.h"
+#include "../include/dragon.h"
+#include "../include/elf.h"
+#include "../include/druid.h"
+
+namespace {
+
+template <typename T>
+std::unique_ptr<Npc> construct(int x, int y, const std::string& name) {
+    return std::make_unique<T>(x, y, name);
+}
+
+}
+
+// Вариант 9: Дракон нападает на эльфов, Эльф - на друидов, Друид - на драконов
+void registerBuiltinNpcKinds(NpcRegistry& registry) {
+    registry.registerKind("Dragon", &construct<Dragon>, {"Elf"});
+    registry.registerKind("Elf", &construct<Elf>, {"Druid"});
+    registry.registerKind("Druid", &construct<Druid>, {"Dragon"});
+}
@@ -0,0 +1,345 @@
+#include "../include/columnar_format.h"
+#include "../include/factory.h"
+#include "../include/morton.h"
+#include "../include/thread_pool.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+
+namespace {
+
+const char kMagic[8] = {'N', 'P', 'C', 'C', 'O', 'L', '0', '1'};
+
+void putVarint(std::vector<char>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void putSigned(std::vector<char>& out, std::int64_t value) {
+    // zigzag: малые по модулю числа любого знака занимают один байт
+    putVarint(out, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+std::uint64_t getVarint(const char*& p, const char* end) {
+    std::uint64_t value = 0;
+    int shift = 0;
+    while (p < end && shift < 64) {
+        auto byte = static_cast<unsigned char>(*p++);
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+        shift += 7;
+    }
+    throw std::runtime_error("Corrupted columnar block");
+}
+
+std::int64_t getSigned(const char*& p, const char* end) {
+    std::uint64_t raw = getVarint(p, end);
+    return static_cast<std::int64_t>(raw >> 1) ^ -static_cast<std::int64_t>(raw & 1);
+}
+
+void writeVarint(std::ofstream& out, std::uint64_t value) {
+    std::vector<char> buffer;
+    putVarint(buffer, value);
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+std::uint64_t readVarint(std::ifstream& in) {
+    std::uint64_t value = 0;
+    int shift = 0;
+    char c;
+    while (shift < 64 && in.get(c)) {
+        auto byte = static_cast<unsigned char>(c);
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+        shift += 7;
+    }
+    throw std::runtime_error("Corrupted columnar header");
+}
+
+struct SortedNpc {
+    std::uint32_t key;
+    ColumnarBlockNpc record;
+};
+
+}
+
+void encodeColumnarBlock(std::span<const ColumnarBlockNpc> npcs, std::vector<char>& out) {
+    out.clear();
+    putVarint(out, npcs.size());
+
+    // Колонка типов: серии одинаковых типов
+    for (size_t i = 0; i < npcs.size();) {
+        size_t run = i;
+        while (run < npcs.size() && npcs[run].typeId == npcs[i].typeId) ++run;
+        putVarint(out, npcs[i].typeId);
+        putVarint(out, run - i);
+        i = run;
+    }
+
+    // Координаты: разности с предыдущим NPC блока
+    int prevX = 0;
+    int prevY = 0;
+    for (const ColumnarBlockNpc& npc : npcs) {
+        putSigned(out, npc.x - prevX);
+        putSigned(out, npc.y - prevY);
+        prevX = npc.x;
+        prevY = npc.y;
+    }
+
+    // Имена: общий префикс с предыдущим именем и хвост
+    std::string_view prevName;
+    for (const ColumnarBlockNpc& npc : npcs) {
+        std::string_view name = npc.name;
+        size_t shared = 0;
+        size_t limit = std::min(name.size(), prevName.size());
+        while (shared < limit && name[shared] == prevName[shared]) ++shared;
+        putVarint(out, shared);
+        putVarint(out, name.size() - shared);
+        out.insert(out.end(), name.begin() + shared, name.end());
+        prevName = name;
+    }
+}
+
+void decodeColumnarBlock(const char* data, size_t size, const std::vector<std::string>& types,
+                         std::vector<ColumnarNpc>& out) {
+    const char* p = data;
+    const char* end = p + size;
+
+    // Каждый NPC занимает в блоке хотя бы по байту на координаты, длину
+    // общего префикса и длину хвоста имени: число из повреждённого файла
+    // не должно приводить к огромному выделению памяти
+    size_t count = getVarint(p, end);
+    if (count > static_cast<size_t>(end - p) / 4) {
+        throw std::runtime_error("Corrupted columnar block");
+    }
+    out.resize(count);
+
+    for (size_t i = 0; i < count;) {
+        size_t typeId = getVarint(p, end);
+        size_t run = getVarint(p, end);
+        if (typeId >= types.size() || run == 0 || i + run > count) {
+            throw std::runtime_error("Corrupted columnar block");
+        }
+        for (size_t j = 0; j < run; ++j) {
+            out[i + j].type = types[typeId];
+        }
+        i += run;
+    }
+
+    int x = 0;
+    int y = 0;
+    for (size_t i = 0; i < count; ++i) {
+        x += static_cast<int>(getSigned(p, end));
+        y += static_cast<int>(getSigned(p, end));
+        out[i].x = x;
+        out[i].y = y;
+    }
+
+    const std::string* prev = nullptr;
+    for (size_t i = 0; i < count; ++i) {
+        size_t shared = getVarint(p, end);
+        size_t tail = getVarint(p, end);
+        if ((prev ? prev->size() : 0) < shared || static_cast<size_t>(end - p) < tail) {
+            throw std::runtime_error("Corrupted columnar block");
+        }
+        std::string& name = out[i].name;
+        name.clear();
+        if (shared > 0) {
+            name.append(*prev, 0, shared);
+        }
+        name.append(p, tail);
+        p += tail;
+        prev = &name;
+    }
+}
+
+size_t ColumnarFormat::save(const Arena& arena, const std::string& filename, size_t blockSize) {
+    if (blockSize == 0) {
+        throw std::invalid_argument("Block size must be positive.");
+    }
+
+    std::vector<std::string> types;
+    std::vector<SortedNpc> npcs;
+    npcs.reserve(arena.getNpcCount());
+    arena.forEachNpc([&](const Npc& npc) {
+        std::string type = npc.getType();
+        auto it = std::find(types.begin(), types.end(), type);
+        if (it == types.end()) {
+            it = types.insert(types.end(), type);
+        }
+        npcs.push_back({mortonKey(static_cast<std::uint16_t>(npc.getX()),
+                                  static_cast<std::uint16_t>(npc.getY())),
+                        {static_cast<std::uint32_t>(it - types.begin()),
+                         npc.getX(), npc.getY(), npc.getName()}});
+    });
+
+    // Пространственная сортировка делает разности координат малыми
+    std::stable_sort(npcs.begin(), npcs.end(), [](const SortedNpc& a, const SortedNpc& b) {
+        return a.key < b.key;
+    });
+
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + filename);
+    }
+
+    size_t blockCount = (npcs.size() + blockSize - 1) / blockSize;
+    out.write(kMagic, sizeof(kMagic));
+    writeVarint(out, npcs.size());
+    writeVarint(out, blockCount);
+    writeVarint(out, types.size());
+    for (const auto& type : types) {
+        writeVarint(out, type.size());
+        out.write(type.data(), static_cast<std::streamsize>(type.size()));
+    }
+
+    std::vector<ColumnarBlockNpc> records;
+    records.reserve(npcs.size());
+    for (const SortedNpc& npc : npcs) {
+        records.push_back(npc.record);
+    }
+
+    std::vector<char> block;
+    for (size_t begin = 0; begin < records.size(); begin += blockSize) {
+        size_t count = std::min(records.size() - begin, blockSize);
+        encodeColumnarBlock(std::span<const ColumnarBlockNpc>(records).subspan(begin, count), block);
+        writeVarint(out, block.size());
+        out.write(block.data(), static_cast<std::streamsize>(block.size()));
+    }
+
+    if (!out) {
+        throw std::runtime_error("Failed to write file: " + filename);
+    }
+    return static_cast<size_t>(out.tellp());
+}
+
+LoadResult ColumnarFormat::load(Arena& arena, const std::string& filename, size_t threads) {
+    ColumnarReader reader(filename);
+    LoadResult result;
+
+    size_t recordNumber = 0;
+    auto insert = [&arena, &result, &recordNumber](std::vector<ColumnarNpc>& decoded) {
+        for (auto& record : decoded) {
+            recordNumber++;
+            auto npc = NpcFactory::tryCreateNpc(record.type, record.name, record.x, record.y);
+            NpcError error = npc ? arena.tryAddNpc(std::move(*npc)) : npc.error();
+            if (error.ok()) {
+                result.loaded++;
+            } else {
+                result.errors.push_back({recordNumber, error});
+            }
+        }
+    };
+
+    if (threads <= 1) {
+        std::vector<char> block;
+        std::vector<ColumnarNpc> decoded;
+        while (reader.readBlock(block)) {
+            reader.decodeBlock(block, decoded);
+            insert(decoded);
+        }
+        return result;
+    }
+
+    // Окно из нескольких блоков: чтение идёт последовательно, декодирование -
+    // параллельно, вставка в арену - в порядке файла
+    struct Slot {
+        std::vector<char> block;
+        std::vector<ColumnarNpc> decoded;
+    };
+    ThreadPool pool(threads);
+    std::deque<Slot> window;
+    bool more = true;
+    while (more) {
+        window.clear();
+        while (window.size() < threads * 2) {
+            Slot slot;
+            if (!reader.readBlock(slot.block)) {
+                more = false;
+                break;
+            }
+            window.push_back(std::move(slot));
+        }
+        for (auto& slot : window) {
+            pool.submit([&reader, &slot] { reader.decodeBlock(slot.block, slot.decoded); });
+        }
+        pool.waitIdle();
+        for (auto& slot : window) {
+            insert(slot.decoded);
+        }
+    }
+    return result;
+}
+
+ColumnarReader::ColumnarReader(const std::string& filename) : in_(filename, std::ios::binary) {
+    if (!in_.is_open()) {
+        throw std::runtime_error("Failed to open file for reading: " + filename);
+    }
+
+    char magic[sizeof(kMagic)];
+    if (!in_.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a columnar NPC file: " + filename);
+    }
+
+    in_.seekg(0, std::ios::end);
+    fileSize_ = static_cast<std::uint64_t>(in_.tellg());
+    in_.seekg(sizeof(kMagic));
+
+    npcCount_ = readVarint(in_);
+    blockCount_ = readVarint(in_);
+    size_t typeCount = readVarint(in_);
+    for (size_t i = 0; i < typeCount; ++i) {
+        std::uint64_t length = readVarint(in_);
+        if (length > remainingBytes()) {
+            throw std::runtime_error("Corrupted columnar header: " + filename);
+        }
+        std::string type(length, '\0');
+        in_.read(&type[0], static_cast<std::streamsize>(type.size()));
+        types_.push_back(std::move(type));
+    }
+    if (!in_) {
+        throw std::runtime_error("Corrupted columnar header: " + filename);
+    }
+}
+
+bool ColumnarReader::readBlock(std::vector<char>& block) {
+    if (blocksRead_ == blockCount_) {
+        return false;
+    }
+    std::uint64_t length = readVarint(in_);
+    if (length > remainingBytes() || length > kMaxBlockBytes) {
+        throw std::runtime_error("Corrupted columnar block");
+    }
+    block.resize(length);
+    if (!in_.read(block.data(), static_cast<std::streamsize>(block.size()))) {
+        throw std::runtime_error("Truncated columnar block");
+    }
+    blocksRead_++;
+    return true;
+}
+
+void ColumnarReader::decodeBlock(const std::vector<char>& block,
+                                 std::vector<ColumnarNpc>& out) const {
+    decodeColumnarBlock(block.data(), block.size(), types_, out);
+}
+
+std::uint64_t ColumnarReader::remainingBytes() {
+    auto position = static_cast<std::uint64_t>(in_.tellg());
+    return position < fileSize_ ? fileSize_ - position : 0;
+}
+
+size_t ColumnarReader::getBlockCount() const {
+    return blockCount_;
+}
+
+size_t ColumnarReader::getNpcCount() const {
+    return npcCount_;
+}
@@ -1,24 +1,6 @@
 #include "../include/combat_visitor.h"
+#include "../include/npc_registry.h"
 
 bool CombatVisitor::canKill(Npc* attacker, Npc* defender) {
-    if (attacker->getType() == "Dragon") {
-        return dragonVs(defender->getType());
-    } else if (attacker->getType() == "Elf") {
-        return elfVs(defender->getType());
-    } else if (attacker->getType() == "Druid") {
-        return druidVs(defender->getType());
-    }
-    return false;
-}
-
-bool CombatVisitor::dragonVs(const std::string& defenderType) {
-    return (defenderType == "Elf");
-}
-
-bool CombatVisitor::elfVs(const std::string& defenderType) {
-    return (defenderType == "Druid");
-}
-
-bool CombatVisitor::druidVs(const std::string& defenderType) {
-    return (defenderType == "Dragon");
+    return NpcRegistry::instance().canKill(attacker->getKind(), defender->getKind());
 }
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "../include/compact_arena.h"
+#include "../include/death_set.h"
+#include "../include/npc_registry.h"
+#include "../include/spatial_index.h"
+#include <algorithm>
+#include <stdexcept>
+
+CompactNpc::CompactNpc(NpcKind kind, int x, int y, std::uint32_t nameId)
+    : x_(static_cast<std::uint16_t>(x)),
+      y_(static_cast<std::uint16_t>(y)),
+      packed_((static_cast<std::uint32_t>(kind) << 30) | (nameId & kMaxNameId)) {}
+
+void CompactNpc::setPosition(int x, int y) {
+    x_ = static_cast<std::uint16_t>(x);
+    y_ = static_cast<std::uint16_t>(y);
+}
+
+std::uint32_t NameTable::intern(std::string_view name) {
+    std::uint32_t existing = find(name);
+    if (existing != kNoName) {
+        return existing;
+    }
+    if (size() >= CompactNpc::kMaxNameId) {
+        throw std::length_error("Name table is full.");
+    }
+    // Смещения 32-битные: символы всех имён не должны превышать 4 ГиБ
+    if (name.size() > kMaxNameBytes - chars_.size()) {
+        throw std::length_error("Name table is out of space for name characters.");
+    }
+
+    auto id = static_cast<std::uint32_t>(size());
+    chars_.insert(chars_.end(), name.begin(), name.end());
+    offsets_.push_back(static_cast<std::uint32_t>(chars_.size()));
+
+    // Заполнение не больше половины
+    if ((size() + 1) * 2 > slots_.size()) {
+        rehash(std::max<size_t>(16, slots_.size() * 2));
+    } else {
+        size_t mask = slots_.size() - 1;
+        size_t slot = hash(name) & mask;
+        while (slots_[slot] != kNoName) {
+            slot = (slot + 1) & mask;
+        }
+        slots_[slot] = id;
+    }
+    return id;
+}
+
+std::uint32_t NameTable::find(std::string_view name) const {
+    if (slots_.empty()) {
+        return kNoName;
+    }
+    size_t mask = slots_.size() - 1;
+    for (size_t slot = hash(name) & mask; slots_[slot] != kNoName; slot = (slot + 1) & mask) {
+        if (this->name(slots_[slot]) == name) {
+            return slots_[slot];
+        }
+    }
+    return kNoName;
+}
+
+std::string_view NameTable::name(std::uint32_t id) const {
+    return std::string_view(chars_.data() + offsets_[id], offsets_[id + 1] - offsets_[id]);
+}
+
+size_t NameTable::size() const {
+    return offsets_.size() - 1;
+}
+
+size_t NameTable::bytesUsed() const {
+    return chars_.capacity() + offsets_.capacity() * sizeof(std::uint32_t) +
+           slots_.capacity() * sizeof(std::uint32_t);
+}
+
+std::uint32_t NameTable::hash(std::string_view name) {
+    // FNV-1a
+    std::uint32_t h = 2166136261u;
+    for (char c : name) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void NameTable::rehash(size_t slotCount) {
+    slots_.assign(slotCount, kNoName);
+    size_t mask = slotCount - 1;
+    for (std::uint32_t id = 0; id < size(); ++id) {
+        size_t slot = hash(name(id)) & mask;
+        while (slots_[slot] != kNoName) {
+            slot = (slot + 1) & mask;
+        }
+        slots_[slot] = id;
+    }
+}
+
+CompactArena::CompactArena(int width, int height) {
+    if (width > MAX_WIDTH || height > MAX_HEIGHT) {
+        throw std::out_of_range("Arena size exceeds maximum limits.");
+    }
+    if (width < 0 || height < 0) {
+        throw std::invalid_argument("Arena dimensions cannot be negative.");
+    }
+    width_ = width;
+    height_ = height;
+}
+
+NpcError CompactArena::tryAddNpc(std::string_view type, std::string_view name, int x, int y) {
+    const NpcKindInfo* info = NpcRegistry::instance().find(type);
+    if (!info || static_cast<size_t>(info->kind) >= CompactNpc::kMaxKinds) {
+        return {NpcErrorCode::UnknownType};
+    }
+    if (x < 0 || x > width_ || y < 0 || y > height_) {
+        return {NpcErrorCode::OutOfArenaBounds};
+    }
+
+    std::uint32_t id = names_.intern(name);
+    if (id >= slotOfName_.size()) {
+        slotOfName_.resize(id + 1, kNoSlot);
+    }
+    if (slotOfName_[id] != kNoSlot) {
+        return {NpcErrorCode::DuplicateName};
+    }
+    slotOfName_[id] = static_cast<std::uint32_t>(npcs_.size());
+    npcs_.emplace_back(info->kind, x, y, id);
+    return {};
+}
+
+void CompactArena::createAndAddNpc(const std::string& type, const std::string& name, int x, int y) {
+    NpcError error = tryAddNpc(type, name, x, y);
+    switch (error.code) {
+        case NpcErrorCode::None:
+            return;
+        case NpcErrorCode::OutOfArenaBounds:
+            throw std::out_of_range("NPC position is out of arena bounds.");
+        case NpcErrorCode::DuplicateName:
+            throw std::invalid_argument("NPC with name '" + name + "' already exists.");
+        default:
+            throw std::invalid_argument("Unknown NPC type: " + type);
+    }
+}
+
+bool CompactArena::removeNpc(std::string_view name) {
+    std::uint32_t id = names_.find(name);
+    if (id == NameTable::kNoName || slotOfName_[id] == kNoSlot) {
+        return false;
+    }
+    std::uint32_t slot = slotOfName_[id];
+    npcs_[slot] = npcs_.back();
+    slotOfName_[npcs_[slot].getNameId()] = slot;
+    npcs_.pop_back();
+    slotOfName_[id] = kNoSlot;
+    return true;
+}
+
+size_t CompactArena::getNpcCount() const {
+    return npcs_.size();
+}
+
+BattleResult CompactArena::startBattle(double range) {
+    if (range < 0) {
+        throw std::invalid_argument("Battle range cannot be negative.");
+    }
+
+    const NpcRegistry& registry = NpcRegistry::instance();
+    KindPairFilter hostilePairs;
+    for (size_t a = 0; a < kNpcKindCount; ++a) {
+        for (size_t b = 0; b < kNpcKindCount; ++b) {
+            hostilePairs.allowed[a][b] = registry.outcome(static_cast<NpcKind>(a),
+                                                          static_cast<NpcKind>(b)) != PairOutcome::None;
+        }
+    }
+
+    std::vector<SpatialPoint> points;
+    points.reserve(npcs_.size());
+    for (size_t i = 0; i < npcs_.size(); ++i) {
+        points.push_back({npcs_[i].getX(), npcs_[i].getY(), i,
+                          static_cast<std::uint8_t>(npcs_[i].getKind())});
+    }
+    KindPartitionedIndex index;
+    index.build(SpatialBackend::Auto, points, range);
+    std::vector<CandidatePair> pairs;
+    index.collectPairsWithin(range, hostilePairs, pairs);
+
+    BattleResult result;
+    result.range = range;
+    result.npcsBefore = npcs_.size();
+
+    DeathSet deaths(npcs_.size());
+    for (const CandidatePair& pair : pairs) {
+        auto bits = static_cast<unsigned>(registry.outcome(npcs_[pair.first].getKind(),
+                                                           npcs_[pair.second].getKind()));
+        if (bits == 0) continue;
+        result.fights++;
+        if (bits & 1) deaths.mark(pair.second);
+        if (bits & 2) deaths.mark(pair.first);
+    }
+
+    // Уплотнение без погибших
+    size_t kept = 0;
+    for (size_t i = 0; i < npcs_.size(); ++i) {
+        std::uint32_t id = npcs_[i].getNameId();
+        if (deaths.contains(i)) {
+            result.killed.emplace_back(names_.name(id));
+            slotOfName_[id] = kNoSlot;
+            continue;
+        }
+        slotOfName_[id] = static_cast<std::uint32_t>(kept);
+        npcs_[kept++] = npcs_[i];
+    }
+    npcs_.resize(kept);
+    std::sort(result.killed.begin(), result.killed.end());
+
+    result.npcsAfter = npcs_.size();
+    return result;
+}
+
+CompactArena CompactArena::fromArena(const Arena& arena) {
+    CompactArena compact(arena.getWidth(), arena.getHeight());
+    compact.npcs_.reserve(arena.getNpcCount());
+    arena.forEachNpc([&compact](const Npc& npc) {
+        compact.createAndAddNpc(npc.getType(), npc.getName(), npc.getX(), npc.getY());
+    });
+    return compact;
+}
+
+size_t CompactArena::bytesUsed() const {
+    return sizeof(*this) + npcs_.capacity() * sizeof(CompactNpc) +
+           slotOfName_.capacity() * sizeof(std::uint32_t) + names_.bytesUsed();
+}
@@ -16,5 +16,5 @@ void Dragon::accept(Visitor& visitor) {
 void Dragon::printInfo() const {
     std::cout << "Dragon Info - Name: " << getName()
               << ", Position: (" << getX() << ", " << getY() << ")"
-              << std::endl;
+              << '\n';
 }
\ No newline at end of file
@@ -14,5 +14,5 @@ void Druid::accept(Visitor& visitor) {
 void Druid::printInfo() const {
     std::cout << "Druid Info - Name: " << getName()
               << ", Position: (" << getX() << ", " << getY() << ")"
-              << std::endl;
+              << '\n';
 }
\ No newline at end of file
@@ -14,5 +14,5 @@ void Elf::accept(Visitor& visitor) {
 void Elf::printInfo() const {
     std::cout << "Elf Info - Name: " << getName()
               << ", Position: (" << getX() << ", " << getY() << ")"
-              << std::endl;
+              << '\n';
 }
\ No newline at end of file
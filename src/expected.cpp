@@ -0,0 +1,18 @@
+#include "../include/expected.h"
+
+std::string NpcError::message() const {
+    switch (code) {
+        case NpcErrorCode::None:
+            return "OK";
+        case NpcErrorCode::ParseFailed:
+        case NpcErrorCode::CoordinatesOutOfRange:
+            return std::string(parseErrorMessage(parse)) + " at column " + std::to_string(column);
+        case NpcErrorCode::UnknownType:
+            return "unknown NPC type";
+        case NpcErrorCode::OutOfArenaBounds:
+            return "NPC position is out of arena bounds";
+        case NpcErrorCode::DuplicateName:
+            return "NPC with this name already exists";
+    }
+    return "unknown error";
+}
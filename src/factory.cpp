@@ -1,43 +1,144 @@
 #include <memory>
 #include <iostream>
 #include "../include/factory.h"
-#include "../include/dragon.h"
-#include "../include/elf.h"
-#include "../include/druid.h"
-#include <sstream>
+#include "../include/npc_registry.h"
+#include "../include/expected.h"
+#include <charconv>
 #include <stdexcept>
 
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+size_t skipSpaces(std::string_view line, size_t pos) {
+    while (pos < line.size() && isSpace(line[pos])) ++pos;
+    return pos;
+}
+
+// Слово до следующего пробельного символа
+std::string_view readToken(std::string_view line, size_t& pos) {
+    pos = skipSpaces(line, pos);
+    size_t start = pos;
+    while (pos < line.size() && !isSpace(line[pos])) ++pos;
+    return line.substr(start, pos - start);
+}
+
+// Целое число, как его читает operator>> (допускается знак '+')
+bool readInt(std::string_view line, size_t& pos, int& value) {
+    pos = skipSpaces(line, pos);
+    const char* begin = line.data() + pos;
+    const char* end = line.data() + line.size();
+    if (begin != end && *begin == '+') {
+        ++begin;
+        // После '+' знак повторяться не может: "+-5" operator>> отвергает
+        if (begin != end && *begin == '-') {
+            return false;
+        }
+    }
+    auto [ptr, ec] = std::from_chars(begin, end, value);
+    if (ec != std::errc()) {
+        return false;
+    }
+    pos = static_cast<size_t>(ptr - line.data());
+    return true;
+}
+
+}
+
+const char* parseErrorMessage(ParseError error) {
+    switch (error) {
+        case ParseError::None: return "OK";
+        case ParseError::MissingType: return "missing NPC type";
+        case ParseError::MissingName: return "missing NPC name";
+        case ParseError::BadX: return "invalid X coordinate";
+        case ParseError::BadY: return "invalid Y coordinate";
+        case ParseError::OutOfRange: return "coordinates out of range (0-500)";
+    }
+    return "unknown error";
+}
+
 std::unique_ptr<Npc> NpcFactory::createNpc(
     const std::string& type,
     const std::string& name,
     int x,
     int y)
 {
-    if (type == "Dragon") {
-        return std::make_unique<Dragon>(x, y, name);
-    } else if (type == "Elf") {
-        return std::make_unique<Elf>(x, y, name);
-    } else if (type == "Druid") {
-        return std::make_unique<Druid>(x, y, name);
-    } else {
+    const NpcKindInfo* info = NpcRegistry::instance().find(type);
+    if (info == nullptr) {
         throw std::invalid_argument("Unknown NPC type: " + type);
     }
+    return info->create(x, y, name);
+}
+
+ParseStatus NpcFactory::parseLine(std::string_view line, ParsedNpcLine& out) noexcept {
+    size_t pos = 0;
+
+    out.type = readToken(line, pos);
+    if (out.type.empty()) {
+        return {ParseError::MissingType, pos + 1};
+    }
+
+    out.name = readToken(line, pos);
+    if (out.name.empty()) {
+        return {ParseError::MissingName, pos + 1};
+    }
+
+    size_t xColumn = skipSpaces(line, pos) + 1;
+    if (!readInt(line, pos, out.x)) {
+        return {ParseError::BadX, xColumn};
+    }
+    size_t yColumn = skipSpaces(line, pos) + 1;
+    if (!readInt(line, pos, out.y)) {
+        return {ParseError::BadY, yColumn};
+    }
+
+    if (out.x < 0 || out.x > 500) {
+        return {ParseError::OutOfRange, xColumn};
+    }
+    if (out.y < 0 || out.y > 500) {
+        return {ParseError::OutOfRange, yColumn};
+    }
+    return {};
 }
 
 std::unique_ptr<Npc> NpcFactory::createFromString(const std::string& line) {
-    std::istringstream iss(line);
-    std::string type, name;
-    int x, y;
+    ParsedNpcLine parsed;
+    ParseStatus status = parseLine(line, parsed);
 
-    iss >> type >> name >> x >> y;
-    
-    if (iss.fail()) {
+    if (status.error == ParseError::OutOfRange) {
+        throw std::out_of_range("Coordinates out of range (0-500): " + line);
+    }
+    if (!status.ok()) {
         throw std::runtime_error("Failed to parse line: " + line);
     }
 
-    if (x < 0 || x > 500 || y < 0 || y > 500) {
-        throw std::out_of_range("Coordinates out of range (0-500): " + line);
+    return createNpc(std::string(parsed.type), std::string(parsed.name), parsed.x, parsed.y);
+}
+
+
+Expected<std::unique_ptr<Npc>> NpcFactory::tryCreateNpc(
+    std::string_view type,
+    std::string_view name,
+    int x,
+    int y)
+{
+    const NpcKindInfo* info = NpcRegistry::instance().find(type);
+    if (info == nullptr) {
+        return NpcError{NpcErrorCode::UnknownType};
     }
+    return info->create(x, y, std::string(name));
+}
 
-    return createNpc(type, name, x, y);
+Expected<std::unique_ptr<Npc>> NpcFactory::tryCreateFromString(std::string_view line) {
+    ParsedNpcLine parsed;
+    ParseStatus status = parseLine(line, parsed);
+    if (!status.ok()) {
+        NpcErrorCode code = status.error == ParseError::OutOfRange
+            ? NpcErrorCode::CoordinatesOutOfRange
+            : NpcErrorCode::ParseFailed;
+        return NpcError{code, status.error, status.column};
+    }
+    return tryCreateNpc(parsed.type, parsed.name, parsed.x, parsed.y);
 }
\ No newline at end of file
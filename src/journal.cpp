@@ -0,0 +1,240 @@
+#include "../include/journal.h"
+#include "../include/factory.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+ArenaJournal::ArenaJournal(Arena& arena,
+                           const std::string& snapshotFile,
+                           const std::string& journalFile,
+                           size_t checkpointInterval)
+    : arena_(arena),
+      snapshotFile_(snapshotFile),
+      journalFile_(journalFile),
+      checkpointInterval_(checkpointInterval) {
+    journal_ = std::make_unique<FileSink>(journalFile_, true);
+}
+
+namespace {
+
+// Атомарная подмена файла. std::rename в Windows не заменяет существующий
+// файл, а в POSIX новое имя доходит до диска только с синхронизацией каталога
+void replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    if (!MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        throw std::runtime_error("Failed to replace snapshot: " + to);
+    }
+#else
+    if (std::rename(from.c_str(), to.c_str()) != 0) {
+        throw std::runtime_error("Failed to replace snapshot: " + to);
+    }
+    size_t slash = to.rfind('/');
+    std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : to.substr(0, slash);
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+#endif
+}
+
+// Собирает погибших по событиям боя и записывает итог в журнал в конце
+// фазы событий - до того, как погибшие будут удалены с арены
+class BattleRecorder : public Observer {
+    public:
+        BattleRecorder(double range, std::function<void(const std::string&)> write)
+            : range_(range), write_(std::move(write)) {}
+
+        void notify(const std::string&) override {}
+
+        void notifyBatch(std::span<const Event>) override {}
+
+        void notifyFights(std::span<const FightEvent> fights) override {
+            for (const FightEvent& fight : fights) {
+                killed_.emplace_back(fight.second);
+                if (fight.mutual) {
+                    killed_.emplace_back(fight.first);
+                }
+            }
+        }
+
+        void battleFinished() override {
+            std::sort(killed_.begin(), killed_.end());
+            killed_.erase(std::unique(killed_.begin(), killed_.end()), killed_.end());
+
+            // Записываем исход, а не параметры боя: повтор не зависит от правил
+            std::ostringstream record;
+            record << "B " << range_;
+            for (const auto& name : killed_) {
+                record << " " << name;
+            }
+            write_(record.str());
+        }
+
+    private:
+        double range_;
+        std::function<void(const std::string&)> write_;
+        std::vector<std::string> killed_;
+};
+
+}
+
+void ArenaJournal::createAndAddNpc(const std::string& type,
+                                   const std::string& name,
+                                   int x, int y) {
+    // Запись делается только для изменения, которое заведомо применится
+    auto npc = NpcFactory::createNpc(type, name, x, y);
+    checkPosition(x, y);
+    if (arena_.hasNpc(name)) {
+        throw std::invalid_argument("NPC with name '" + name + "' already exists.");
+    }
+    write("A " + type + " " + name + " " + std::to_string(x) + " " + std::to_string(y));
+    arena_.addNpc(std::move(npc));
+    applied();
+}
+
+bool ArenaJournal::removeNpc(const std::string& name) {
+    if (!arena_.hasNpc(name)) {
+        return false;
+    }
+    write("R " + name);
+    arena_.removeNpc(name);
+    applied();
+    return true;
+}
+
+void ArenaJournal::moveNpc(const std::string& name, int x, int y) {
+    if (!arena_.hasNpc(name)) {
+        throw std::invalid_argument("NPC with name '" + name + "' does not exist.");
+    }
+    checkPosition(x, y);
+    write("M " + name + " " + std::to_string(x) + " " + std::to_string(y));
+    arena_.moveNpc(name, x, y);
+    applied();
+}
+
+BattleResult ArenaJournal::startBattle(double range) {
+    if (range < 0) {
+        throw std::invalid_argument("Battle range cannot be negative.");
+    }
+    // Итог попадает в журнал между оценкой боя и удалением погибших; если
+    // запись не удалась, бой прерывается до изменения арены
+    auto recorder = std::make_shared<BattleRecorder>(range, [this](const std::string& record) {
+        write(record);
+    });
+    arena_.addObserver(recorder);
+    BattleResult result;
+    try {
+        result = arena_.startBattle(range);
+    } catch (...) {
+        arena_.removeObserver(recorder);
+        throw;
+    }
+    arena_.removeObserver(recorder);
+    applied();
+    return result;
+}
+
+void ArenaJournal::checkpoint() {
+    // Снимок пишется во временный файл, сбрасывается на диск и атомарно
+    // подменяет старый; журнал обнуляется только после этого
+    std::string tempFile = snapshotFile_ + ".tmp";
+    arena_.saveToFile(tempFile);
+    FileSink snapshot(tempFile, true);
+    snapshot.sync();
+    snapshot.close();
+    replaceFile(tempFile, snapshotFile_);
+
+    journal_.reset();
+    journal_ = std::make_unique<FileSink>(journalFile_);
+    pendingRecords_ = 0;
+}
+
+size_t ArenaJournal::getPendingRecords() const {
+    return pendingRecords_;
+}
+
+void ArenaJournal::write(const std::string& record) {
+    std::string line = record + '\n';
+    try {
+        journal_->write(line.data(), line.size());
+        journal_->sync();
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error("Failed to write journal: " + journalFile_ + ": " + e.what());
+    }
+}
+
+void ArenaJournal::applied() {
+    pendingRecords_++;
+    if (checkpointInterval_ > 0 && pendingRecords_ >= checkpointInterval_) {
+        checkpoint();
+    }
+}
+
+void ArenaJournal::checkPosition(int x, int y) const {
+    if (x < 0 || x > arena_.getWidth() || y < 0 || y > arena_.getHeight()) {
+        throw std::out_of_range("NPC position is out of arena bounds.");
+    }
+}
+
+size_t ArenaJournal::recover(Arena& arena,
+                             const std::string& snapshotFile,
+                             const std::string& journalFile) {
+    arena.clear();
+    if (std::ifstream(snapshotFile).good()) {
+        arena.loadFromFile(snapshotFile);
+    }
+
+    std::ifstream journal(journalFile);
+    size_t applied = 0;
+    std::string line;
+    while (std::getline(journal, line)) {
+        std::istringstream iss(line);
+        std::string op;
+        iss >> op;
+
+        // Запись могла быть прервана сбоем или уже отражена в снимке
+        try {
+            if (op == "A") {
+                std::string type, name;
+                int x, y;
+                if (!(iss >> type >> name >> x >> y)) continue;
+                arena.createAndAddNpc(type, name, x, y);
+            } else if (op == "R") {
+                std::string name;
+                if (!(iss >> name)) continue;
+                arena.removeNpc(name);
+            } else if (op == "M") {
+                std::string name;
+                int x, y;
+                if (!(iss >> name >> x >> y)) continue;
+                arena.moveNpc(name, x, y);
+            } else if (op == "B") {
+                double range;
+                if (!(iss >> range)) continue;
+                std::string name;
+                while (iss >> name) {
+                    arena.removeNpc(name);
+                }
+            } else {
+                continue;
+            }
+            applied++;
+        } catch (const std::exception&) {
+            continue;
+        }
+    }
+    return applied;
+}
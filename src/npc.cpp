@@ -4,7 +4,7 @@
 #include <iostream>
 
 Npc::Npc(int x, int y, const std::string& type, const std::string& name)
-    : x_(x), y_(y), type_(type), name_(name) {}
+    : x_(x), y_(y), type_(type), name_(name), kind_(kindFromType(type)) {}
 
 int Npc::getX() const {
     return x_;
@@ -14,14 +14,23 @@ int Npc::getY() const {
     return y_;
 }
 
-std::string Npc::getType() const {
+const std::string& Npc::getType() const {
     return type_;
 }
 
-std::string Npc::getName() const {
+const std::string& Npc::getName() const {
     return name_;
 }
 
+NpcKind Npc::getKind() const {
+    return kind_;
+}
+
+void Npc::setPosition(int x, int y) {
+    x_ = x;
+    y_ = y;
+}
+
 double Npc::distanceTo(const Npc& other) const {
     int dx = x_ - other.x_;
     int dy = y_ - other.y_;
@@ -29,7 +38,7 @@ double Npc::distanceTo(const Npc& other) const {
 }
 
 void Npc::printInfo() const {
-    std::cout << *this << std::endl;
+    std::cout << *this << '\n';
 }
 
 std::ostream& operator<<(std::ostream& os, const Npc& npc) {
@@ -0,0 +1,12 @@
+#include "../include/npc_kind.h"
+#include "../include/npc_registry.h"
+
+NpcKind kindFromType(const std::string& type) {
+    const NpcKindInfo* info = NpcRegistry::instance().find(type);
+    return info ? info->kind : NpcKind::Unknown;
+}
+
+const char* kindName(NpcKind kind) {
+    const NpcKindInfo* info = NpcRegistry::instance().info(kind);
+    return info ? info->type.c_str() : "Unknown";
+}
@@ -0,0 +1,29 @@
+#include "../include/npc_record.h"
+#include "../include/npc_registry.h"
+#include <cmath>
+#include <stdexcept>
+
+NpcRecord NpcRecord::fromNpc(const Npc& npc) {
+    return {npc.getKind(), npc.getX(), npc.getY(), npc.getName()};
+}
+
+std::unique_ptr<Npc> NpcRecord::toNpc() const {
+    const NpcKindInfo* info = NpcRegistry::instance().info(kind);
+    if (!info || !info->create) {
+        throw std::logic_error("Cannot create NPC of unregistered kind: " + name);
+    }
+    return info->create(x, y, name);
+}
+
+double NpcRecord::distanceTo(const NpcRecord& other) const {
+    int dx = x - other.x;
+    int dy = y - other.y;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+void acceptRecord(NpcRecord& record, Visitor& visitor) {
+    std::unique_ptr<Npc> npc = record.toNpc();
+    npc->accept(visitor);
+    record.x = npc->getX();
+    record.y = npc->getY();
+}
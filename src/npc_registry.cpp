@@ -0,0 +1,124 @@
+#include "../include/npc_registry.h"
+#include <stdexcept>
+
+NpcRegistry& NpcRegistry::instance() {
+    static NpcRegistry registry;
+    return registry;
+}
+
+NpcRegistry::NpcRegistry() {
+    // Число видов ограничено kNpcKindCount: вектор не перевыделяется, и
+    // указатели из find()/info() остаются действительными после регистраций
+    kinds_.reserve(kNpcKindCount);
+    registerBuiltinNpcKinds(*this);
+}
+
+NpcKind NpcRegistry::registerKind(const std::string& type,
+                                  NpcConstructor create,
+                                  const std::vector<std::string>& prey) {
+    if (find(type) != nullptr) {
+        throw std::invalid_argument("NPC type already registered: " + type);
+    }
+    // Последний номер зарезервирован под NpcKind::Unknown
+    if (kinds_.size() + 1 >= kNpcKindCount) {
+        throw std::length_error("Too many NPC kinds registered.");
+    }
+
+    NpcKindInfo info;
+    info.type = type;
+    info.kind = static_cast<NpcKind>(kinds_.size());
+    info.create = create;
+    info.prey = prey;
+    kinds_.push_back(info);
+
+    rebuildHash();
+    rebuildRules();
+    return kinds_.back().kind;
+}
+
+const NpcKindInfo* NpcRegistry::find(std::string_view type) const {
+    if (slots_.empty()) {
+        return nullptr;
+    }
+    int index = slots_[hash(type, seed_) & (slots_.size() - 1)];
+    // Единственное сравнение отсекает неизвестные типы
+    if (index < 0 || kinds_[index].type != type) {
+        return nullptr;
+    }
+    return &kinds_[index];
+}
+
+const NpcKindInfo* NpcRegistry::info(NpcKind kind) const {
+    auto index = static_cast<size_t>(kind);
+    return index < kinds_.size() ? &kinds_[index] : nullptr;
+}
+
+size_t NpcRegistry::size() const {
+    return kinds_.size();
+}
+
+std::uint32_t NpcRegistry::hash(std::string_view type, std::uint32_t seed) {
+    // FNV-1a с примешанным зерном
+    std::uint32_t h = 2166136261u ^ seed;
+    for (char c : type) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+void NpcRegistry::rebuildHash() {
+    size_t tableSize = 4;
+    while (tableSize < kinds_.size() * 2) {
+        tableSize *= 2;
+    }
+
+    // Подбор зерна, при котором все типы попадают в разные ячейки
+    for (std::uint32_t seed = 0;; ++seed) {
+        std::vector<int> slots(tableSize, -1);
+        bool collision = false;
+        for (size_t i = 0; i < kinds_.size() && !collision; ++i) {
+            auto slot = hash(kinds_[i].type, seed) & (tableSize - 1);
+            if (slots[slot] >= 0) {
+                collision = true;
+            } else {
+                slots[slot] = static_cast<int>(i);
+            }
+        }
+        if (!collision) {
+            slots_ = std::move(slots);
+            seed_ = seed;
+            return;
+        }
+    }
+}
+
+void NpcRegistry::rebuildRules() {
+    for (auto& row : hostile_) {
+        for (bool& cell : row) {
+            cell = false;
+        }
+    }
+    // Жертва может быть зарегистрирована позже охотника
+    for (const auto& attacker : kinds_) {
+        for (const auto& preyType : attacker.prey) {
+            if (const NpcKindInfo* defender = find(preyType)) {
+                hostile_[static_cast<size_t>(attacker.kind)][static_cast<size_t>(defender->kind)] = true;
+            }
+        }
+    }
+
+    for (size_t first = 0; first < kNpcKindCount; ++first) {
+        for (size_t second = 0; second < kNpcKindCount; ++second) {
+            unsigned bits = (hostile_[first][second] ? 1u : 0u) |
+                            (hostile_[second][first] ? 2u : 0u);
+            outcomes_[first][second] = static_cast<PairOutcome>(bits);
+        }
+    }
+}
+
+NpcRegistrar::NpcRegistrar(const std::string& type,
+                           NpcConstructor create,
+                           const std::vector<std::string>& prey) {
+    NpcRegistry::instance().registerKind(type, create, prey);
+}
@@ -0,0 +1,193 @@
+#include "../include/npc_writer.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Системные вызовы ввода-вывода: POSIX или их аналоги из CRT Windows
+#ifdef _WIN32
+int openForWriting(const std::string& filename, bool append) {
+    return ::_open(filename.c_str(),
+                   _O_WRONLY | _O_CREAT | (append ? _O_APPEND : _O_TRUNC) | _O_BINARY | _O_NOINHERIT,
+                   _S_IREAD | _S_IWRITE);
+}
+
+// _write принимает размер типа unsigned int: большие блоки пишутся частями
+long long writeSome(int fd, const char* data, std::size_t size) {
+    return ::_write(fd, data, static_cast<unsigned int>(std::min<std::size_t>(size, 1u << 30)));
+}
+
+int syncFile(int fd) {
+    return ::_commit(fd);
+}
+
+int closeFile(int fd) {
+    return ::_close(fd);
+}
+#else
+int openForWriting(const std::string& filename, bool append) {
+    return ::open(filename.c_str(), O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC) | O_CLOEXEC, 0644);
+}
+
+long long writeSome(int fd, const char* data, std::size_t size) {
+    return ::write(fd, data, size);
+}
+
+int syncFile(int fd) {
+    return ::fsync(fd);
+}
+
+int closeFile(int fd) {
+    return ::close(fd);
+}
+#endif
+
+void writeAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        long long written = writeSome(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("Write failed: ") + std::strerror(errno));
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+// Самая длинная запись целого числа
+const std::size_t kMaxIntChars = 12;
+
+}
+
+FdSink::FdSink(int fd) : fd_(fd) {}
+
+void FdSink::write(const char* data, std::size_t size) {
+    writeAll(fd_, data, size);
+}
+
+FileSink::FileSink(const std::string& filename, bool append) : filename_(filename) {
+    fd_ = openForWriting(filename, append);
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open file for writing: " + filename);
+    }
+}
+
+FileSink::~FileSink() {
+    if (fd_ >= 0) {
+        closeFile(fd_);
+    }
+}
+
+void FileSink::write(const char* data, std::size_t size) {
+    if (fd_ < 0) {
+        throw std::runtime_error("File already closed: " + filename_);
+    }
+    writeAll(fd_, data, size);
+}
+
+void FileSink::sync() {
+    if (fd_ < 0) {
+        throw std::runtime_error("File already closed: " + filename_);
+    }
+    if (syncFile(fd_) != 0) {
+        throw std::runtime_error("Failed to sync file: " + filename_ + ": " + std::strerror(errno));
+    }
+}
+
+void FileSink::close() {
+    if (fd_ < 0) return;
+    int result = closeFile(fd_);
+    fd_ = -1;
+    if (result != 0) {
+        throw std::runtime_error("Failed to close file: " + filename_);
+    }
+}
+
+void OstreamSink::write(const char* data, std::size_t size) {
+    os_.write(data, static_cast<std::streamsize>(size));
+    if (!os_) {
+        throw std::runtime_error("Stream write failed");
+    }
+}
+
+NpcTextWriter::NpcTextWriter(TextSink& sink, std::size_t blockSize)
+    : sink_(sink), buffer_(std::max<std::size_t>(blockSize, 256)) {}
+
+NpcTextWriter::~NpcTextWriter() {
+    try {
+        flush();
+    } catch (...) {
+    }
+}
+
+void NpcTextWriter::writeRecord(const Npc& npc) {
+    append(npc.getType());
+    append(' ');
+    append(npc.getName());
+    append(' ');
+    append(npc.getX());
+    append(' ');
+    append(npc.getY());
+    append('\n');
+}
+
+void NpcTextWriter::writeInfo(const Npc& npc) {
+    append("NPC Type: ");
+    append(npc.getType());
+    append(", Name: ");
+    append(npc.getName());
+    append(", Position: (");
+    append(npc.getX());
+    append(", ");
+    append(npc.getY());
+    append(')');
+}
+
+void NpcTextWriter::append(std::string_view text) {
+    if (text.size() > buffer_.size()) {
+        // Длинный фрагмент идёт в приёмник напрямую
+        flush();
+        sink_.write(text.data(), text.size());
+        return;
+    }
+    reserve(text.size());
+    std::memcpy(buffer_.data() + used_, text.data(), text.size());
+    used_ += text.size();
+}
+
+void NpcTextWriter::append(char c) {
+    reserve(1);
+    buffer_[used_++] = c;
+}
+
+void NpcTextWriter::append(int value) {
+    reserve(kMaxIntChars);
+    char* begin = buffer_.data() + used_;
+    auto [end, error] = std::to_chars(begin, begin + kMaxIntChars, value);
+    (void)error;
+    used_ += static_cast<std::size_t>(end - begin);
+}
+
+void NpcTextWriter::flush() {
+    if (used_ == 0) return;
+    // Буфер очищается до записи, чтобы при ошибке не повторить блок
+    std::size_t size = used_;
+    used_ = 0;
+    sink_.write(buffer_.data(), size);
+}
+
+void NpcTextWriter::reserve(std::size_t size) {
+    if (buffer_.size() - used_ < size) {
+        flush();
+    }
+}
@@ -0,0 +1,122 @@
+#include "../include/perf_counters.h"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* hardwareCounterName(HardwareCounter counter) {
+    switch (counter) {
+        case HardwareCounter::Cycles: return "cycles";
+        case HardwareCounter::Instructions: return "instructions";
+        case HardwareCounter::CacheMisses: return "cacheMisses";
+        case HardwareCounter::BranchMisses: return "branchMisses";
+    }
+    return "unknown";
+}
+
+PhaseCounters& PhaseCounters::operator+=(const PhaseCounters& other) {
+    for (std::size_t i = 0; i < kHardwareCounterCount; ++i) {
+        values[i] += other.values[i];
+    }
+    available |= other.available;
+    return *this;
+}
+
+#ifdef __linux__
+
+namespace {
+
+int openCounter(std::uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // Счётчики открыты порознь, и при нехватке регистров ядро их чередует:
+    // время включения и работы нужно для пересчёта на всю фазу
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // Текущий поток на любом процессоре
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+}
+
+PerfCounters::PerfCounters() {
+    const std::uint64_t configs[kHardwareCounterCount] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+    for (std::size_t i = 0; i < kHardwareCounterCount; ++i) {
+        fds_[i] = openCounter(configs[i]);
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds_) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+void PerfCounters::start() {
+    for (int fd : fds_) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+PhaseCounters PerfCounters::stop() {
+    PhaseCounters result;
+    for (std::size_t i = 0; i < kHardwareCounterCount; ++i) {
+        if (fds_[i] < 0) continue;
+        ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+        // value, time_enabled, time_running
+        std::uint64_t data[3] = {};
+        if (read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) continue;
+        std::uint64_t value = data[0];
+        std::uint64_t enabled = data[1];
+        std::uint64_t running = data[2];
+        // Счётчик, ни разу не попавший на процессор, ничего не измерил
+        if (running == 0) continue;
+        if (running < enabled) {
+            value = static_cast<std::uint64_t>(static_cast<double>(value) * enabled / running);
+        }
+        result.values[i] = value;
+        result.available |= 1u << i;
+    }
+    return result;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+    for (int& fd : fds_) {
+        fd = -1;
+    }
+}
+
+PerfCounters::~PerfCounters() = default;
+
+void PerfCounters::start() {}
+
+PhaseCounters PerfCounters::stop() {
+    return {};
+}
+
+#endif
+
+bool PerfCounters::available() const {
+    for (int fd : fds_) {
+        if (fd >= 0) return true;
+    }
+    return false;
+}
@@ -0,0 +1,385 @@
+#include "../include/region_arena.h"
+#include "../include/columnar_format.h"
+#include "../include/morton.h"
+#include "../include/npc_registry.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const char kMagic[8] = {'N', 'P', 'C', 'R', 'E', 'G', '0', '1'};
+
+// Таблица типов файла - типы реестра по номерам видов, поэтому номер
+// типа записи совпадает с номером её вида
+std::vector<std::string> registryTypes() {
+    const NpcRegistry& registry = NpcRegistry::instance();
+    std::vector<std::string> types;
+    for (size_t kind = 0; kind < registry.size(); ++kind) {
+        types.push_back(registry.info(static_cast<NpcKind>(kind))->type);
+    }
+    return types;
+}
+
+// Запись файла регионов: заголовок и индекс резервируются в начале и
+// заполняются в finish(), когда известны смещения блоков
+class RegionFileWriter {
+    public:
+        RegionFileWriter(const std::string& filename, RegionFileHeader header)
+            : out_(filename, std::ios::binary), filename_(filename), header_(header) {
+            if (!out_.is_open()) {
+                throw std::runtime_error("Failed to open file for writing: " + filename);
+            }
+            types_ = registryTypes();
+            std::memcpy(header_.magic, kMagic, sizeof(kMagic));
+            header_.typeCount = static_cast<std::uint32_t>(types_.size());
+            header_.npcCount = 0;
+            index_.resize(static_cast<size_t>(header_.cols) * header_.rows);
+
+            out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+            for (const std::string& type : types_) {
+                auto length = static_cast<std::uint32_t>(type.size());
+                out_.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                out_.write(type.data(), length);
+            }
+            indexOffset_ = out_.tellp();
+            out_.write(reinterpret_cast<const char*>(index_.data()),
+                       static_cast<std::streamsize>(index_.size() * sizeof(RegionIndexEntry)));
+        }
+
+        // Регион из записей: NPC упорядочиваются по ключу Мортона
+        void writeRegion(size_t index, const std::vector<NpcRecord>& npcs) {
+            std::vector<const NpcRecord*> sorted;
+            sorted.reserve(npcs.size());
+            for (const NpcRecord& npc : npcs) {
+                sorted.push_back(&npc);
+            }
+            std::sort(sorted.begin(), sorted.end(), [](const NpcRecord* a, const NpcRecord* b) {
+                return mortonKey(static_cast<std::uint16_t>(a->x), static_cast<std::uint16_t>(a->y)) <
+                       mortonKey(static_cast<std::uint16_t>(b->x), static_cast<std::uint16_t>(b->y));
+            });
+
+            std::vector<ColumnarBlockNpc> records;
+            records.reserve(sorted.size());
+            for (const NpcRecord* npc : sorted) {
+                records.push_back({static_cast<std::uint32_t>(npc->kind), npc->x, npc->y, npc->name});
+            }
+            encodeColumnarBlock(records, block_);
+            writeRawRegion(index, block_, npcs.size());
+        }
+
+        // Уже закодированный блок (копирование неизменённого региона)
+        void writeRawRegion(size_t index, const std::vector<char>& block, size_t npcCount) {
+            RegionIndexEntry& entry = index_[index];
+            entry.offset = static_cast<std::uint64_t>(out_.tellp());
+            entry.size = static_cast<std::uint32_t>(block.size());
+            entry.npcCount = static_cast<std::uint32_t>(npcCount);
+            out_.write(block.data(), static_cast<std::streamsize>(block.size()));
+            header_.npcCount += npcCount;
+        }
+
+        const std::vector<RegionIndexEntry>& finish() {
+            out_.seekp(0);
+            out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+            out_.seekp(indexOffset_);
+            out_.write(reinterpret_cast<const char*>(index_.data()),
+                       static_cast<std::streamsize>(index_.size() * sizeof(RegionIndexEntry)));
+            out_.close();
+            if (!out_) {
+                throw std::runtime_error("Failed to write file: " + filename_);
+            }
+            return index_;
+        }
+
+        const RegionFileHeader& getHeader() const {
+            return header_;
+        }
+
+    private:
+        std::ofstream out_;
+        std::string filename_;
+        RegionFileHeader header_;
+        std::vector<std::string> types_;
+        std::vector<RegionIndexEntry> index_;
+        std::streampos indexOffset_;
+        std::vector<char> block_;
+};
+
+RegionFileHeader makeHeader(int width, int height, int regionSize) {
+    if (regionSize <= 0) {
+        throw std::invalid_argument("Region size must be positive.");
+    }
+    RegionFileHeader header{};
+    header.width = static_cast<std::uint32_t>(width);
+    header.height = static_cast<std::uint32_t>(height);
+    header.regionSize = static_cast<std::uint32_t>(regionSize);
+    // Координаты включают границу арены
+    header.cols = static_cast<std::uint32_t>(width / regionSize + 1);
+    header.rows = static_cast<std::uint32_t>(height / regionSize + 1);
+    return header;
+}
+
+}
+
+size_t RegionArena::save(const Arena& arena, const std::string& filename, int regionSize) {
+    RegionFileWriter writer(filename, makeHeader(arena.getWidth(), arena.getHeight(), regionSize));
+    const RegionFileHeader& header = writer.getHeader();
+
+    std::vector<std::vector<NpcRecord>> regions(static_cast<size_t>(header.cols) * header.rows);
+    arena.forEachNpc([&](const Npc& npc) {
+        size_t column = static_cast<size_t>(npc.getX()) / header.regionSize;
+        size_t row = static_cast<size_t>(npc.getY()) / header.regionSize;
+        regions[row * header.cols + column].push_back(NpcRecord::fromNpc(npc));
+    });
+    for (size_t index = 0; index < regions.size(); ++index) {
+        writer.writeRegion(index, regions[index]);
+    }
+    writer.finish();
+    return arena.getNpcCount();
+}
+
+RegionArena::RegionArena(const std::string& filename, size_t maxResidentRegions)
+    : file_(filename, std::ios::binary), filename_(filename),
+      maxResident_(std::max<size_t>(maxResidentRegions, 1)) {
+    if (!file_.is_open()) {
+        throw std::runtime_error("Failed to open file for reading: " + filename);
+    }
+    if (!file_.read(reinterpret_cast<char*>(&header_), sizeof(header_)) ||
+        std::memcmp(header_.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a region file: " + filename);
+    }
+
+    // Размеры из заголовка проверяются до выделения памяти под них: разбиение
+    // должно совпадать с тем, что записал бы save(), а длины - умещаться в файл
+    std::streampos headerEnd = file_.tellg();
+    file_.seekg(0, std::ios::end);
+    auto fileSize = static_cast<std::uint64_t>(file_.tellg());
+    file_.seekg(headerEnd);
+    auto remainingBytes = [&]() {
+        auto position = static_cast<std::uint64_t>(file_.tellg());
+        return position < fileSize ? fileSize - position : 0;
+    };
+    if (header_.regionSize == 0 || header_.regionSize >= INT_MAX ||
+        header_.width >= INT_MAX || header_.height >= INT_MAX) {
+        throw std::runtime_error("Corrupted region file header: " + filename);
+    }
+    RegionFileHeader expected = makeHeader(static_cast<int>(header_.width), static_cast<int>(header_.height),
+                                           static_cast<int>(header_.regionSize));
+    if (header_.cols != expected.cols || header_.rows != expected.rows) {
+        throw std::runtime_error("Corrupted region file header: " + filename);
+    }
+
+    const NpcRegistry& registry = NpcRegistry::instance();
+    for (std::uint32_t i = 0; i < header_.typeCount; ++i) {
+        std::uint32_t length = 0;
+        file_.read(reinterpret_cast<char*>(&length), sizeof(length));
+        if (!file_ || length > remainingBytes()) {
+            throw std::runtime_error("Corrupted region file header: " + filename);
+        }
+        std::string type(length, '\0');
+        file_.read(type.data(), length);
+        if (!file_) {
+            throw std::runtime_error("Corrupted region file header: " + filename);
+        }
+        if (registry.find(type) == nullptr) {
+            throw std::runtime_error("Unknown NPC type in region file: " + type);
+        }
+        types_.push_back(std::move(type));
+    }
+
+    std::uint64_t regionCount = static_cast<std::uint64_t>(header_.cols) * header_.rows;
+    if (regionCount > remainingBytes() / sizeof(RegionIndexEntry)) {
+        throw std::runtime_error("Corrupted region file index: " + filename);
+    }
+    std::vector<RegionIndexEntry> index(static_cast<size_t>(regionCount));
+    file_.read(reinterpret_cast<char*>(index.data()),
+               static_cast<std::streamsize>(index.size() * sizeof(RegionIndexEntry)));
+    if (!file_) {
+        throw std::runtime_error("Corrupted region file index: " + filename);
+    }
+    regions_.resize(index.size());
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (index[i].offset > fileSize || index[i].size > fileSize - index[i].offset) {
+            throw std::runtime_error("Corrupted region file index: " + filename);
+        }
+        regions_[i].entry = index[i];
+        regions_[i].lruPosition = lru_.end();
+    }
+}
+
+size_t RegionArena::getNpcCount() const {
+    size_t count = 0;
+    for (const Region& region : regions_) {
+        count += region.resident ? region.npcs.size() : region.entry.npcCount;
+    }
+    return count;
+}
+
+size_t RegionArena::getRegionCount() const {
+    return regions_.size();
+}
+
+size_t RegionArena::getResidentRegionCount() const {
+    return resident_;
+}
+
+size_t RegionArena::getRegionLoads() const {
+    return loads_;
+}
+
+BattleResult RegionArena::startBattle(double range, const RegionRect& area) {
+    std::vector<size_t> touched = touchRegions(area);
+
+    // Бой проводит обычная арена над NPC области
+    Arena battlefield(static_cast<int>(header_.width), static_cast<int>(header_.height));
+    for (size_t index : touched) {
+        for (const NpcRecord& npc : regions_[index].npcs) {
+            if (area.contains(npc.x, npc.y)) {
+                battlefield.addNpc(npc.toNpc());
+            }
+        }
+    }
+    BattleResult result = battlefield.startBattle(range);
+
+    // Погибшие (упорядочены по имени) удаляются из своих регионов
+    if (!result.killed.empty()) {
+        for (size_t index : touched) {
+            Region& region = regions_[index];
+            auto removed = std::remove_if(region.npcs.begin(), region.npcs.end(), [&](const NpcRecord& npc) {
+                return area.contains(npc.x, npc.y) &&
+                       std::binary_search(result.killed.begin(), result.killed.end(), npc.name);
+            });
+            if (removed != region.npcs.end()) {
+                region.npcs.erase(removed, region.npcs.end());
+                if (!region.dirty) {
+                    // Изменённый регион не выгружается и уходит из очереди
+                    lru_.erase(region.lruPosition);
+                    region.lruPosition = lru_.end();
+                    region.dirty = true;
+                }
+            }
+        }
+    }
+    evictOverLimit();
+    return result;
+}
+
+size_t RegionArena::saveToFile(const std::string& filename) {
+    if (filename == filename_) {
+        throw std::invalid_argument("Region file cannot be saved over itself: " + filename);
+    }
+    RegionFileWriter writer(filename, makeHeader(static_cast<int>(header_.width),
+                                                 static_cast<int>(header_.height),
+                                                 static_cast<int>(header_.regionSize)));
+
+    // Неизменённые регионы копируются блоком без разбора
+    std::vector<char> block;
+    for (size_t index = 0; index < regions_.size(); ++index) {
+        Region& region = regions_[index];
+        if (region.dirty) {
+            writer.writeRegion(index, region.npcs);
+            continue;
+        }
+        block.resize(region.entry.size);
+        file_.seekg(static_cast<std::streamoff>(region.entry.offset));
+        if (!file_.read(block.data(), static_cast<std::streamsize>(block.size()))) {
+            throw std::runtime_error("Truncated region block in " + filename_);
+        }
+        writer.writeRawRegion(index, block, region.entry.npcCount);
+    }
+    std::vector<RegionIndexEntry> index = writer.finish();
+    size_t saved = static_cast<size_t>(writer.getHeader().npcCount);
+
+    // Дальше регионы подгружаются из нового файла; изменения сохранены,
+    // и регионы снова можно выгружать
+    file_.close();
+    file_.clear();
+    file_.open(filename, std::ios::binary);
+    if (!file_.is_open()) {
+        throw std::runtime_error("Failed to open file for reading: " + filename);
+    }
+    filename_ = filename;
+    for (size_t i = 0; i < regions_.size(); ++i) {
+        Region& region = regions_[i];
+        region.entry = index[i];
+        if (region.dirty) {
+            region.dirty = false;
+            region.lruPosition = lru_.insert(lru_.begin(), i);
+        }
+    }
+    evictOverLimit();
+    return saved;
+}
+
+std::vector<size_t> RegionArena::touchRegions(const RegionRect& area) {
+    std::vector<size_t> touched;
+    if (area.maxX < 0 || area.maxY < 0 || area.minX > area.maxX || area.minY > area.maxY) {
+        return touched;
+    }
+    auto clampCell = [this](int coordinate, std::uint32_t cells) {
+        auto cell = static_cast<std::uint32_t>(std::max(coordinate, 0)) / header_.regionSize;
+        return std::min(cell, cells - 1);
+    };
+    std::uint32_t minColumn = clampCell(area.minX, header_.cols);
+    std::uint32_t maxColumn = clampCell(area.maxX, header_.cols);
+    std::uint32_t minRow = clampCell(area.minY, header_.rows);
+    std::uint32_t maxRow = clampCell(area.maxY, header_.rows);
+
+    for (std::uint32_t row = minRow; row <= maxRow; ++row) {
+        for (std::uint32_t column = minColumn; column <= maxColumn; ++column) {
+            size_t index = static_cast<size_t>(row) * header_.cols + column;
+            Region& region = regions_[index];
+            if (!region.resident) {
+                readRegion(index, region.npcs);
+                region.resident = true;
+                resident_++;
+                if (!region.dirty) {
+                    region.lruPosition = lru_.insert(lru_.begin(), index);
+                }
+            } else if (!region.dirty) {
+                lru_.splice(lru_.begin(), lru_, region.lruPosition);
+            }
+            touched.push_back(index);
+        }
+    }
+    return touched;
+}
+
+void RegionArena::readRegion(size_t index, std::vector<NpcRecord>& out) {
+    const RegionIndexEntry& entry = regions_[index].entry;
+    std::vector<char> block(entry.size);
+    file_.seekg(static_cast<std::streamoff>(entry.offset));
+    if (!file_.read(block.data(), static_cast<std::streamsize>(block.size()))) {
+        throw std::runtime_error("Truncated region block in " + filename_);
+    }
+    loads_++;
+
+    std::vector<ColumnarNpc> decoded;
+    decodeColumnarBlock(block.data(), block.size(), types_, decoded);
+    const NpcRegistry& registry = NpcRegistry::instance();
+    out.clear();
+    out.reserve(decoded.size());
+    for (ColumnarNpc& npc : decoded) {
+        NpcRecord record;
+        record.kind = registry.find(npc.type)->kind;
+        record.x = npc.x;
+        record.y = npc.y;
+        record.name = std::move(npc.name);
+        out.push_back(std::move(record));
+    }
+}
+
+void RegionArena::evictOverLimit() {
+    // Давно не использованные неизменённые регионы выгружаются первыми:
+    // они в конце очереди, поэтому каждая выгрузка - O(1)
+    while (resident_ > maxResident_ && !lru_.empty()) {
+        Region& oldest = regions_[lru_.back()];
+        lru_.pop_back();
+        oldest.lruPosition = lru_.end();
+        oldest.npcs.clear();
+        oldest.npcs.shrink_to_fit();
+        oldest.resident = false;
+        resident_--;
+    }
+}
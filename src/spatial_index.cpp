@@ -0,0 +1,519 @@
+#include "../include/spatial_index.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Небольшой запас при отсечении по квадрату расстояния, чтобы ошибка
+// округления range * range не отбросила пару, которую примет withinRange
+double pruneThreshold(double range) {
+    return range * range * (1.0 + 1e-12) + 1e-9;
+}
+
+long long boxGap(int aMin, int aMax, int bMin, int bMax) {
+    if (aMax < bMin) {
+        return static_cast<long long>(bMin - aMax);
+    }
+    if (bMax < aMin) {
+        return static_cast<long long>(aMin - bMax);
+    }
+    return 0;
+}
+
+void pushPair(std::size_t a, std::size_t b, std::vector<CandidatePair>& out) {
+    if (a < b) {
+        out.push_back({a, b});
+    } else {
+        out.push_back({b, a});
+    }
+}
+
+// Проверка одной пары: сначала отбор по видам, затем расстояние
+class PairTester {
+    public:
+        PairTester(double range, const KindPairFilter* filter, std::vector<CandidatePair>& out)
+            : range_(range), filter_(filter), out_(out) {}
+
+        void test(const SpatialPoint& a, const SpatialPoint& b) {
+            if (filter_ && !filter_->allowed[a.kind][b.kind] && !filter_->allowed[b.kind][a.kind]) {
+                return;
+            }
+            ++checks_;
+            if (withinRange(a.x - b.x, a.y - b.y, range_)) {
+                pushPair(a.index, b.index, out_);
+            }
+        }
+
+        double getRange() const { return range_; }
+        const KindPairFilter* getFilter() const { return filter_; }
+        size_t getChecks() const { return checks_; }
+
+    private:
+        double range_;
+        const KindPairFilter* filter_;
+        std::vector<CandidatePair>& out_;
+        size_t checks_ = 0;
+};
+
+size_t collectBruteForce(const std::vector<SpatialPoint>& points, double range,
+                         std::vector<CandidatePair>& out, const KindPairFilter* filter) {
+    PairTester tester(range, filter, out);
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        for (std::size_t j = i + 1; j < points.size(); ++j) {
+            tester.test(points[i], points[j]);
+        }
+    }
+    return tester.getChecks();
+}
+
+void sortPairs(std::vector<CandidatePair>& out) {
+    std::sort(out.begin(), out.end(), [](const CandidatePair& a, const CandidatePair& b) {
+        return a.first != b.first ? a.first < b.first : a.second < b.second;
+    });
+}
+
+// Номера ячеек [first, last] вдоль оси, пересекающих отрезок [lo, hi]
+bool cellSpan(double lo, double hi, int origin, int cellSize, int count, int& first, int& last) {
+    double from = std::floor((lo - origin) / cellSize);
+    double to = std::floor((hi - origin) / cellSize);
+    if (to < 0 || from > count - 1) return false;
+    first = from < 0 ? 0 : static_cast<int>(from);
+    last = to > count - 1 ? count - 1 : static_cast<int>(to);
+    return true;
+}
+
+}
+
+std::string spatialBackendName(SpatialBackend backend) {
+    switch (backend) {
+        case SpatialBackend::Auto: return "Auto";
+        case SpatialBackend::BruteForce: return "BruteForce";
+        case SpatialBackend::UniformGrid: return "UniformGrid";
+        case SpatialBackend::KdTree: return "KdTree";
+    }
+    return "Unknown";
+}
+
+bool withinRange(int dx, int dy, double range) {
+    return std::sqrt(dx * dx + dy * dy) <= range;
+}
+
+bool KindPairFilter::anyAllowed(std::uint8_t kindsA, std::uint8_t kindsB) const {
+    for (std::size_t a = 0; a < kNpcKindCount; ++a) {
+        if (!(kindsA & (1u << a))) continue;
+        for (std::size_t b = 0; b < kNpcKindCount; ++b) {
+            if ((kindsB & (1u << b)) && allowed[a][b]) return true;
+        }
+    }
+    return false;
+}
+
+void UniformGrid::build(const std::vector<SpatialPoint>& points, double range) {
+    points_.clear();
+    cellStart_.clear();
+    if (points.empty()) {
+        cols_ = rows_ = 0;
+        return;
+    }
+
+    int maxX = std::numeric_limits<int>::min();
+    int maxY = std::numeric_limits<int>::min();
+    minX_ = std::numeric_limits<int>::max();
+    minY_ = std::numeric_limits<int>::max();
+    for (const auto& p : points) {
+        minX_ = std::min(minX_, p.x);
+        minY_ = std::min(minY_, p.y);
+        maxX = std::max(maxX, p.x);
+        maxY = std::max(maxY, p.y);
+    }
+
+    // Ячейка не меньше дальности: пары ищутся только в соседних ячейках
+    int extent = std::max(maxX - minX_, maxY - minY_) + 1;
+    double cell = std::max(1.0, std::ceil(range));
+    cellSize_ = static_cast<int>(std::min(cell, static_cast<double>(extent)));
+    cols_ = (maxX - minX_) / cellSize_ + 1;
+    rows_ = (maxY - minY_) / cellSize_ + 1;
+
+    // Сортировка подсчётом по номеру ячейки
+    std::vector<std::size_t> counts(static_cast<std::size_t>(cols_) * rows_ + 1, 0);
+    auto cellOf = [this](const SpatialPoint& p) {
+        return static_cast<std::size_t>((p.y - minY_) / cellSize_) * cols_ +
+               static_cast<std::size_t>((p.x - minX_) / cellSize_);
+    };
+    for (const auto& p : points) {
+        counts[cellOf(p) + 1]++;
+    }
+    for (std::size_t i = 1; i < counts.size(); ++i) {
+        counts[i] += counts[i - 1];
+    }
+    cellStart_ = counts;
+    points_.resize(points.size());
+    for (const auto& p : points) {
+        points_[counts[cellOf(p)]++] = p;
+    }
+}
+
+size_t UniformGrid::collectPairsWithin(double range, std::vector<CandidatePair>& out,
+                                       const KindPairFilter* filter) const {
+    // Половина окрестности, чтобы каждая пара соседних ячеек встречалась один раз
+    static const int kNeighbours[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+    PairTester tester(range, filter, out);
+
+    for (int cy = 0; cy < rows_; ++cy) {
+        for (int cx = 0; cx < cols_; ++cx) {
+            std::size_t cell = static_cast<std::size_t>(cy) * cols_ + cx;
+            std::size_t begin = cellStart_[cell];
+            std::size_t end = cellStart_[cell + 1];
+            if (begin == end) continue;
+
+            for (std::size_t i = begin; i < end; ++i) {
+                for (std::size_t j = i + 1; j < end; ++j) {
+                    tester.test(points_[i], points_[j]);
+                }
+            }
+
+            for (const auto& offset : kNeighbours) {
+                int nx = cx + offset[0];
+                int ny = cy + offset[1];
+                if (nx < 0 || nx >= cols_ || ny >= rows_) continue;
+                std::size_t other = static_cast<std::size_t>(ny) * cols_ + nx;
+                for (std::size_t i = begin; i < end; ++i) {
+                    for (std::size_t j = cellStart_[other]; j < cellStart_[other + 1]; ++j) {
+                        tester.test(points_[i], points_[j]);
+                    }
+                }
+            }
+        }
+    }
+    return tester.getChecks();
+}
+
+size_t UniformGrid::collectCrossPairs(const std::vector<SpatialPoint>& queries, double range,
+                                      std::vector<CandidatePair>& out) const {
+    PairTester tester(range, nullptr, out);
+    if (cols_ == 0) return 0;
+
+    for (const auto& q : queries) {
+        int cx0, cx1, cy0, cy1;
+        if (!cellSpan(q.x - range, q.x + range, minX_, cellSize_, cols_, cx0, cx1) ||
+            !cellSpan(q.y - range, q.y + range, minY_, cellSize_, rows_, cy0, cy1)) {
+            continue;
+        }
+        // Ячейки одной строки лежат в CSR подряд
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            std::size_t row = static_cast<std::size_t>(cy) * cols_;
+            for (std::size_t j = cellStart_[row + cx0]; j < cellStart_[row + cx1 + 1]; ++j) {
+                tester.test(q, points_[j]);
+            }
+        }
+    }
+    return tester.getChecks();
+}
+
+void KdTree::build(const std::vector<SpatialPoint>& points) {
+    points_ = points;
+    nodes_.clear();
+    if (points_.empty()) return;
+    nodes_.reserve(2 * (points_.size() / kLeafSize + 1));
+    buildNode(0, points_.size());
+}
+
+int KdTree::buildNode(std::size_t begin, std::size_t end) {
+    Node node;
+    node.begin = begin;
+    node.end = end;
+    node.minX = node.minY = std::numeric_limits<int>::max();
+    node.maxX = node.maxY = std::numeric_limits<int>::min();
+    for (std::size_t i = begin; i < end; ++i) {
+        node.minX = std::min(node.minX, points_[i].x);
+        node.maxX = std::max(node.maxX, points_[i].x);
+        node.minY = std::min(node.minY, points_[i].y);
+        node.maxY = std::max(node.maxY, points_[i].y);
+        node.kinds |= static_cast<std::uint8_t>(1u << points_[i].kind);
+    }
+
+    int id = static_cast<int>(nodes_.size());
+    nodes_.push_back(node);
+    if (end - begin <= kLeafSize) {
+        return id;
+    }
+
+    // Делим по медиане вдоль более длинной стороны прямоугольника
+    bool splitX = (node.maxX - node.minX) >= (node.maxY - node.minY);
+    std::size_t mid = begin + (end - begin) / 2;
+    std::nth_element(points_.begin() + begin, points_.begin() + mid, points_.begin() + end,
+                     [splitX](const SpatialPoint& a, const SpatialPoint& b) {
+                         return splitX ? a.x < b.x : a.y < b.y;
+                     });
+
+    int left = buildNode(begin, mid);
+    int right = buildNode(mid, end);
+    nodes_[id].left = left;
+    nodes_[id].right = right;
+    return id;
+}
+
+size_t KdTree::getNodeCount() const {
+    return nodes_.size();
+}
+
+struct KdTree::Traversal {
+    PairTester tester;
+    double rangeSq;
+};
+
+size_t KdTree::collectPairsWithin(double range, std::vector<CandidatePair>& out,
+                                  const KindPairFilter* filter) const {
+    if (nodes_.empty()) return 0;
+    Traversal traversal{PairTester(range, filter, out), pruneThreshold(range)};
+    dualTraverse(0, 0, traversal);
+    return traversal.tester.getChecks();
+}
+
+void KdTree::dualTraverse(int a, int b, Traversal& traversal) const {
+    const Node& na = nodes_[a];
+    const Node& nb = nodes_[b];
+
+    long long dx = boxGap(na.minX, na.maxX, nb.minX, nb.maxX);
+    long long dy = boxGap(na.minY, na.maxY, nb.minY, nb.maxY);
+    if (static_cast<double>(dx * dx + dy * dy) > traversal.rangeSq) return;
+
+    // Узлы без враждебных сочетаний видов отсекаются целиком
+    const KindPairFilter* filter = traversal.tester.getFilter();
+    if (filter && !filter->anyAllowed(na.kinds, nb.kinds) &&
+        !filter->anyAllowed(nb.kinds, na.kinds)) {
+        return;
+    }
+
+    bool leafA = na.left < 0;
+    bool leafB = nb.left < 0;
+
+    if (leafA && leafB) {
+        for (std::size_t i = na.begin; i < na.end; ++i) {
+            std::size_t j = (a == b) ? i + 1 : nb.begin;
+            for (; j < nb.end; ++j) {
+                traversal.tester.test(points_[i], points_[j]);
+            }
+        }
+        return;
+    }
+
+    if (a == b) {
+        dualTraverse(na.left, na.left, traversal);
+        dualTraverse(na.left, na.right, traversal);
+        dualTraverse(na.right, na.right, traversal);
+        return;
+    }
+
+    // Спускаемся по узлу с большим числом точек
+    if (leafB || (!leafA && (na.end - na.begin) >= (nb.end - nb.begin))) {
+        dualTraverse(na.left, b, traversal);
+        dualTraverse(na.right, b, traversal);
+    } else {
+        dualTraverse(a, nb.left, traversal);
+        dualTraverse(a, nb.right, traversal);
+    }
+}
+
+size_t KdTree::collectCrossPairs(const KdTree& other, double range,
+                                 std::vector<CandidatePair>& out) const {
+    if (nodes_.empty() || other.nodes_.empty()) return 0;
+    Traversal traversal{PairTester(range, nullptr, out), pruneThreshold(range)};
+    crossTraverse(other, 0, 0, traversal);
+    return traversal.tester.getChecks();
+}
+
+void KdTree::crossTraverse(const KdTree& other, int a, int b, Traversal& traversal) const {
+    const Node& na = nodes_[a];
+    const Node& nb = other.nodes_[b];
+
+    long long dx = boxGap(na.minX, na.maxX, nb.minX, nb.maxX);
+    long long dy = boxGap(na.minY, na.maxY, nb.minY, nb.maxY);
+    if (static_cast<double>(dx * dx + dy * dy) > traversal.rangeSq) return;
+
+    bool leafA = na.left < 0;
+    bool leafB = nb.left < 0;
+
+    if (leafA && leafB) {
+        for (std::size_t i = na.begin; i < na.end; ++i) {
+            for (std::size_t j = nb.begin; j < nb.end; ++j) {
+                traversal.tester.test(points_[i], other.points_[j]);
+            }
+        }
+        return;
+    }
+
+    if (leafB || (!leafA && (na.end - na.begin) >= (nb.end - nb.begin))) {
+        crossTraverse(other, na.left, b, traversal);
+        crossTraverse(other, na.right, b, traversal);
+    } else {
+        crossTraverse(other, a, nb.left, traversal);
+        crossTraverse(other, a, nb.right, traversal);
+    }
+}
+
+SpatialBackend chooseSpatialBackend(const std::vector<SpatialPoint>& points, double range) {
+    const std::size_t kBruteForceLimit = 64;
+    const int kProbeCells = 16;
+    const double kClusteredVariation = 1.5;
+
+    if (points.size() <= kBruteForceLimit) {
+        return SpatialBackend::BruteForce;
+    }
+
+    int minX = std::numeric_limits<int>::max();
+    int minY = std::numeric_limits<int>::max();
+    int maxX = std::numeric_limits<int>::min();
+    int maxY = std::numeric_limits<int>::min();
+    for (const auto& p : points) {
+        minX = std::min(minX, p.x);
+        minY = std::min(minY, p.y);
+        maxX = std::max(maxX, p.x);
+        maxY = std::max(maxY, p.y);
+    }
+
+    // Дальность накрывает всю область: любой индекс вырождается в перебор
+    double extent = std::max(maxX - minX, maxY - minY);
+    if (range >= extent) {
+        return SpatialBackend::BruteForce;
+    }
+
+    // Коэффициент вариации заполненности грубой сетки 16x16:
+    // у равномерного распределения он мал, у кластеров - велик
+    std::vector<double> counts(kProbeCells * kProbeCells, 0.0);
+    double cellW = (maxX - minX + 1) / static_cast<double>(kProbeCells);
+    double cellH = (maxY - minY + 1) / static_cast<double>(kProbeCells);
+    for (const auto& p : points) {
+        int cx = std::min(kProbeCells - 1, static_cast<int>((p.x - minX) / cellW));
+        int cy = std::min(kProbeCells - 1, static_cast<int>((p.y - minY) / cellH));
+        counts[cy * kProbeCells + cx] += 1.0;
+    }
+
+    double mean = static_cast<double>(points.size()) / counts.size();
+    double variance = 0.0;
+    for (double c : counts) {
+        variance += (c - mean) * (c - mean);
+    }
+    variance /= counts.size();
+    double variation = std::sqrt(variance) / mean;
+
+    return variation > kClusteredVariation ? SpatialBackend::KdTree
+                                           : SpatialBackend::UniformGrid;
+}
+
+PairSearchInfo collectPairsWithin(SpatialBackend backend,
+                                  const std::vector<SpatialPoint>& points,
+                                  double range,
+                                  std::vector<CandidatePair>& out,
+                                  const KindPairFilter* filter) {
+    out.clear();
+    if (backend == SpatialBackend::Auto) {
+        backend = chooseSpatialBackend(points, range);
+    }
+
+    PairSearchInfo info;
+    info.backend = backend;
+
+    switch (backend) {
+        case SpatialBackend::UniformGrid: {
+            UniformGrid grid;
+            grid.build(points, range);
+            info.distanceChecks = grid.collectPairsWithin(range, out, filter);
+            break;
+        }
+        case SpatialBackend::KdTree: {
+            KdTree tree;
+            tree.build(points);
+            info.distanceChecks = tree.collectPairsWithin(range, out, filter);
+            break;
+        }
+        default:
+            info.distanceChecks = collectBruteForce(points, range, out, filter);
+            break;
+    }
+
+    sortPairs(out);
+    return info;
+}
+
+void KindPartitionedIndex::build(SpatialBackend backend, const std::vector<SpatialPoint>& points,
+                                 double range) {
+    backend_ = backend == SpatialBackend::Auto ? chooseSpatialBackend(points, range) : backend;
+    for (auto& partition : partitions_) {
+        partition.points.clear();
+    }
+    for (const auto& p : points) {
+        partitions_[p.kind].points.push_back(p);
+    }
+
+    for (auto& partition : partitions_) {
+        if (partition.points.empty()) continue;
+        if (backend_ == SpatialBackend::UniformGrid) {
+            partition.grid.build(partition.points, range);
+        } else if (backend_ == SpatialBackend::KdTree) {
+            partition.tree.build(partition.points);
+        }
+    }
+}
+
+PairSearchInfo KindPartitionedIndex::collectPairsWithin(double range, const KindPairFilter& filter,
+                                                        std::vector<CandidatePair>& out) const {
+    out.clear();
+    PairSearchInfo info;
+    info.backend = backend_;
+
+    for (std::size_t a = 0; a < kNpcKindCount; ++a) {
+        if (partitions_[a].points.empty()) continue;
+        if (filter.allowed[a][a]) {
+            info.distanceChecks += selfJoin(partitions_[a], range, out);
+        }
+        for (std::size_t b = a + 1; b < kNpcKindCount; ++b) {
+            if (partitions_[b].points.empty()) continue;
+            if (filter.allowed[a][b] || filter.allowed[b][a]) {
+                info.distanceChecks += join(partitions_[a], partitions_[b], range, out);
+            }
+        }
+    }
+
+    sortPairs(out);
+    return info;
+}
+
+size_t KindPartitionedIndex::getPartitionSize(NpcKind kind) const {
+    return partitions_[static_cast<std::size_t>(kind)].points.size();
+}
+
+size_t KindPartitionedIndex::join(const Partition& a, const Partition& b, double range,
+                                  std::vector<CandidatePair>& out) const {
+    switch (backend_) {
+        case SpatialBackend::UniformGrid:
+            // Меньший вид опрашивает сетку большего
+            return a.points.size() <= b.points.size()
+                ? b.grid.collectCrossPairs(a.points, range, out)
+                : a.grid.collectCrossPairs(b.points, range, out);
+        case SpatialBackend::KdTree:
+            return a.tree.collectCrossPairs(b.tree, range, out);
+        default: {
+            PairTester tester(range, nullptr, out);
+            for (const auto& p : a.points) {
+                for (const auto& q : b.points) {
+                    tester.test(p, q);
+                }
+            }
+            return tester.getChecks();
+        }
+    }
+}
+
+size_t KindPartitionedIndex::selfJoin(const Partition& partition, double range,
+                                      std::vector<CandidatePair>& out) const {
+    switch (backend_) {
+        case SpatialBackend::UniformGrid:
+            return partition.grid.collectPairsWithin(range, out);
+        case SpatialBackend::KdTree:
+            return partition.tree.collectPairsWithin(range, out);
+        default:
+            return collectBruteForce(partition.points, range, out, nullptr);
+    }
+}
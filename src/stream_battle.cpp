@@ -0,0 +1,164 @@
+#include "../include/stream_battle.h"
+#include "../include/combat_visitor.h"
+#include "../include/factory.h"
+#include "../include/expected.h"
+#include "../include/spatial_index.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+StreamBattle::StreamBattle(double range, double stripWidth)
+    : range_(range), stripWidth_(stripWidth) {
+    if (range < 0) {
+        throw std::invalid_argument("Battle range cannot be negative.");
+    }
+    // Полоса не уже дальности, иначе пара может оказаться через полосу
+    stripWidth_ = std::max({stripWidth_, range_, 1.0});
+}
+
+void StreamBattle::addObserver(std::shared_ptr<Observer> observer) {
+    observers_.push_back(observer);
+}
+
+double StreamBattle::getStripWidth() const {
+    return stripWidth_;
+}
+
+void StreamBattle::notifyObservers(const std::string& event) {
+    for (auto& observer : observers_) {
+        observer->notify(event);
+    }
+}
+
+StreamBattleResult StreamBattle::run(const std::string& inputFile, const std::string& outputFile) {
+    std::ifstream in(inputFile);
+    if (!in.is_open()) {
+        throw std::runtime_error("Failed to open file for reading: " + inputFile);
+    }
+    std::ofstream out(outputFile);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + outputFile);
+    }
+
+    StreamBattleResult result;
+    std::vector<Entry> previous;
+    std::vector<Entry> current;
+    long long previousStrip = -2;
+    long long currentStrip = -1;
+    int lastX = -1;
+
+    auto writeSurvivors = [&out, &result](std::vector<Entry>& strip) {
+        for (const auto& entry : strip) {
+            if (entry.dead) continue;
+            out << entry.npc->getType() << " "
+                << entry.npc->getName() << " "
+                << entry.npc->getX() << " "
+                << entry.npc->getY() << "\n";
+            result.written++;
+        }
+        strip.clear();
+    };
+
+    // Полоса заполнена: бои внутри неё и с предыдущей полосой, после чего
+    // предыдущая полоса больше ни с кем не встретится и может быть записана
+    auto closeStrip = [&]() {
+        if (previousStrip != currentStrip - 1) {
+            writeSurvivors(previous);
+        }
+        fight(previous, current, result);
+        writeSurvivors(previous);
+        std::swap(previous, current);
+        previousStrip = currentStrip;
+    };
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+
+        auto parsed = NpcFactory::tryCreateFromString(line);
+        if (!parsed) {
+            result.skippedLines++;
+            continue;
+        }
+        std::unique_ptr<Npc> npc = std::move(*parsed);
+
+        if (npc->getX() < lastX) {
+            throw std::runtime_error("Input file is not sorted by X: " + line);
+        }
+        lastX = npc->getX();
+        result.read++;
+
+        long long strip = static_cast<long long>(std::floor(npc->getX() / stripWidth_));
+        if (strip != currentStrip) {
+            if (!current.empty()) {
+                closeStrip();
+            }
+            currentStrip = strip;
+        }
+        current.push_back({std::move(npc), false});
+        result.peakResident = std::max(result.peakResident, previous.size() + current.size());
+    }
+
+    if (!current.empty()) {
+        closeStrip();
+    }
+    writeSurvivors(previous);
+
+    if (!out) {
+        throw std::runtime_error("Failed to write file: " + outputFile);
+    }
+    return result;
+}
+
+void StreamBattle::fight(std::vector<Entry>& previous, std::vector<Entry>& current,
+                         StreamBattleResult& result) {
+    // Точки обеих полос; пары внутри предыдущей полосы уже разыграны
+    std::vector<SpatialPoint> points;
+    points.reserve(previous.size() + current.size());
+    for (size_t i = 0; i < previous.size(); ++i) {
+        points.push_back({previous[i].npc->getX(), previous[i].npc->getY(), i});
+    }
+    for (size_t i = 0; i < current.size(); ++i) {
+        points.push_back({current[i].npc->getX(), current[i].npc->getY(), previous.size() + i});
+    }
+
+    std::vector<CandidatePair> pairs;
+    collectPairsWithin(SpatialBackend::Auto, points, range_, pairs);
+
+    auto entryAt = [&](size_t index) -> Entry& {
+        return index < previous.size() ? previous[index] : current[index - previous.size()];
+    };
+
+    CombatVisitor visitor;
+    for (const auto& pair : pairs) {
+        if (pair.second < previous.size()) continue;
+
+        Entry& first = entryAt(pair.first);
+        Entry& second = entryAt(pair.second);
+        Npc* npc1 = first.npc.get();
+        Npc* npc2 = second.npc.get();
+
+        bool npc1KillsNpc2 = visitor.canKill(npc1, npc2);
+        bool npc2KillsNpc1 = visitor.canKill(npc2, npc1);
+
+        if (npc1KillsNpc2 && npc2KillsNpc1) {
+            notifyObservers(npc1->getName() + " (" + npc1->getType() +
+                            ") and " + npc2->getName() + " (" + npc2->getType() +
+                            ") killed each other");
+        } else if (npc1KillsNpc2) {
+            notifyObservers(npc1->getName() + " (" + npc1->getType() +
+                            ") killed " + npc2->getName() + " (" + npc2->getType() + ")");
+        } else if (npc2KillsNpc1) {
+            notifyObservers(npc2->getName() + " (" + npc2->getType() +
+                            ") killed " + npc1->getName() + " (" + npc1->getType() + ")");
+        } else {
+            continue;
+        }
+
+        // Как и в Arena::startBattle, погибшие продолжают сражаться до конца боя
+        if (npc1KillsNpc2) second.dead = true;
+        if (npc2KillsNpc1) first.dead = true;
+        result.fights++;
+    }
+}
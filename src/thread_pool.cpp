@@ -0,0 +1,136 @@
+#include "../include/thread_pool.h"
+#include "../include/trace.h"
+#include <string>
+
+namespace {
+thread_local int tWorkerIndex = -1;
+thread_local const void* tWorkerPool = nullptr;
+}
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads_.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    try {
+        waitIdle();
+    } catch (...) {
+        // Ошибки задач, не забранные через waitIdle, при разрушении отбрасываются
+    }
+    {
+        std::lock_guard<std::mutex> lock(waitMutex_);
+        stopping_ = true;
+    }
+    workAvailable_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    size_t index;
+    if (tWorkerPool == this) {
+        index = static_cast<size_t>(tWorkerIndex);
+    } else {
+        index = nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    }
+
+    pending_.fetch_add(1, std::memory_order_acq_rel);
+    queued_.fetch_add(1, std::memory_order_acq_rel);
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // Захват мьютекса исключает потерю пробуждения между проверкой и ожиданием
+        std::lock_guard<std::mutex> lock(waitMutex_);
+    }
+    workAvailable_.notify_one();
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(waitMutex_);
+    idle_.wait(lock, [this] { return pending_.load(std::memory_order_acquire) == 0; });
+    if (firstError_) {
+        std::exception_ptr error = firstError_;
+        firstError_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return threads_.size();
+}
+
+int ThreadPool::currentWorker() {
+    return tWorkerIndex;
+}
+
+bool ThreadPool::tryPop(size_t index, std::function<void()>& task) {
+    WorkerQueue& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    // Свои задачи берём с конца (LIFO) - они ещё "горячие" в кэше
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    queued_.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+bool ThreadPool::trySteal(size_t thief, std::function<void()>& task) {
+    for (size_t offset = 1; offset < queues_.size(); ++offset) {
+        WorkerQueue& queue = *queues_[(thief + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            queued_.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    tWorkerIndex = static_cast<int>(index);
+    tWorkerPool = this;
+    Tracer::instance().setThreadName("worker " + std::to_string(index));
+
+    while (true) {
+        std::function<void()> task;
+        if (tryPop(index, task) || trySteal(index, task)) {
+            try {
+                TraceSpan span("task", "pool");
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(waitMutex_);
+                if (!firstError_) {
+                    firstError_ = std::current_exception();
+                }
+            }
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(waitMutex_);
+                idle_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(waitMutex_);
+        workAvailable_.wait(lock, [this] {
+            return stopping_ || queued_.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping_ && queued_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,154 @@
+#include "../include/trace.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace {
+
+std::int64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void writeJsonString(std::ostream& os, const std::string& text) {
+    os << '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                       << static_cast<int>(c) << std::dec << std::setfill(' ');
+                } else {
+                    os << c;
+                }
+        }
+    }
+    os << '"';
+}
+
+// Микросекунды с дробной частью - единица формата trace-event
+void writeMicros(std::ostream& os, std::uint64_t ns) {
+    os << ns / 1000 << '.' << std::setw(3) << std::setfill('0') << ns % 1000 << std::setfill(' ');
+}
+
+}
+
+thread_local std::shared_ptr<Tracer::ThreadBuffer> Tracer::localBuffer_;
+thread_local std::string Tracer::localName_;
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::start() {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    // Последняя ссылка на буфер - у трассы: поток завершился, и после
+    // очистки от него осталась бы лишь пустая временная шкала
+    buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(), [](const auto& buffer) {
+        return buffer.use_count() == 1;
+    }), buffers_.end());
+    for (auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+    }
+    epochNs_.store(steadyNs(), std::memory_order_relaxed);
+    enabled_.store(true, std::memory_order_release);
+}
+
+void Tracer::stop() {
+    enabled_.store(false, std::memory_order_release);
+}
+
+std::uint64_t Tracer::now() const {
+    std::int64_t elapsed = steadyNs() - epochNs_.load(std::memory_order_relaxed);
+    return elapsed > 0 ? static_cast<std::uint64_t>(elapsed) : 0;
+}
+
+Tracer::ThreadBuffer& Tracer::localBuffer() {
+    if (!localBuffer_) {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        buffer->tid = ++nextTid_;
+        buffer->name = localName_.empty() ? "thread " + std::to_string(buffer->tid) : localName_;
+        buffers_.push_back(buffer);
+        localBuffer_ = buffer;
+    }
+    return *localBuffer_;
+}
+
+void Tracer::record(const TraceEvent& event) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events.push_back(event);
+}
+
+void Tracer::setThreadName(const std::string& name) {
+#if ARENA_ENABLE_TRACING
+    localName_ = name;
+    if (localBuffer_) {
+        std::lock_guard<std::mutex> lock(localBuffer_->mutex);
+        localBuffer_->name = name;
+    }
+#else
+    (void)name;
+#endif
+}
+
+size_t Tracer::getEventCount() const {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    size_t count = 0;
+    for (const auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        count += buffer->events.size();
+    }
+    return count;
+}
+
+void Tracer::writeJson(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&] {
+        if (!first) os << ",\n";
+        first = false;
+    };
+
+    for (const auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        separator();
+        os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+           << ",\"args\":{\"name\":";
+        writeJsonString(os, buffer->name);
+        os << "}}";
+
+        for (const TraceEvent& event : buffer->events) {
+            separator();
+            os << "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+               << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid << ",\"ts\":";
+            writeMicros(os, event.startNs);
+            os << ",\"dur\":";
+            writeMicros(os, event.durationNs);
+            if (event.argName != nullptr) {
+                os << ",\"args\":{\"" << event.argName << "\":" << event.argValue << "}";
+            }
+            os << "}";
+        }
+    }
+    os << "]}\n";
+}
+
+void Tracer::saveJson(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + filename);
+    }
+    writeJson(file);
+    if (!file) {
+        throw std::runtime_error("Failed to write file: " + filename);
+    }
+}
@@ -3,9 +3,14 @@
 #include "../include/factory.h"
 #include "../include/console_observer.h"
 #include "../include/file_observer.h"
+#include "../include/npc_writer.h"
+#include "../include/morton.h"
+#include <algorithm>
 #include <memory>
 #include <fstream>
 #include <sstream>
+#include <thread>
+#include <tuple>
 
 TEST(ArenaTest, CreateArena) {
     Arena arena(500, 500);
@@ -156,6 +161,73 @@ TEST(ArenaTest, SaveAndLoadRoundtrip) {
     std::remove(filename.c_str());
 }
 
+TEST(ArenaTest, SaveAsyncKeepsStateAtCall) {
+    std::string filename = "test_save_async.txt";
+    Arena arena;
+    arena.createAndAddNpc("Dragon", "Smaug", 111, 222);
+    arena.createAndAddNpc("Elf", "Legolas", 333, 444);
+
+    Task<SaveResult> saving = arena.saveAsync(filename);
+    // Изменения после вызова в сохранение не попадают
+    arena.removeNpc("Smaug");
+    arena.moveNpc("Legolas", 1, 1);
+    arena.createAndAddNpc("Druid", "Malfurion", 5, 5);
+
+    SaveResult saved = syncWait(std::move(saving));
+    EXPECT_EQ(saved.saved, 2u);
+
+    std::ifstream file(filename);
+    std::stringstream content;
+    content << file.rdbuf();
+    file.close();
+    EXPECT_EQ(content.str(), "Elf Legolas 333 444\nDragon Smaug 111 222\n");
+    EXPECT_EQ(arena.getNpcCount(), 2u);
+
+    std::remove(filename.c_str());
+}
+
+TEST(ArenaTest, LoadAsyncAcrossChunks) {
+    // Файл больше блока чтения: строки разрезаются границами блоков
+    std::string filename = "test_load_async.txt";
+    const int count = 60000;
+    {
+        std::ofstream file(filename);
+        for (int i = 0; i < count; ++i) {
+            file << (i % 2 ? "Elf" : "Dragon") << " NpcWithLongerName" << i << " "
+                 << i % 500 << " " << i / 500 << "\n";
+            if (i == 10) {
+                file << "Orc Grom 1 1\n";
+            }
+        }
+        // Последняя строка без перевода строки
+        file << "Druid Last 7 7";
+    }
+
+    Arena arena;
+    LoadResult result = syncWait(arena.loadAsync(filename));
+    Arena expected;
+    LoadResult expectedResult = expected.loadFromFile(filename);
+    std::remove(filename.c_str());
+
+    EXPECT_EQ(result.loaded, static_cast<size_t>(count + 1));
+    EXPECT_EQ(arena.getNpcCount(), static_cast<size_t>(count + 1));
+    ASSERT_EQ(result.errors.size(), 1u);
+    EXPECT_EQ(result.errors[0].line, 12u);
+    EXPECT_EQ(result.errors[0].error.code, NpcErrorCode::UnknownType);
+
+    EXPECT_EQ(result.loaded, expectedResult.loaded);
+    std::vector<std::string> loaded;
+    std::vector<std::string> reference;
+    arena.forEachNpc([&](const Npc& npc) { loaded.push_back(npc.getName()); });
+    expected.forEachNpc([&](const Npc& npc) { reference.push_back(npc.getName()); });
+    EXPECT_EQ(loaded, reference);
+}
+
+TEST(ArenaTest, LoadAsyncMissingFileThrows) {
+    Arena arena;
+    EXPECT_THROW(syncWait(arena.loadAsync("nonexistent_file.txt")), std::runtime_error);
+}
+
 TEST(ArenaTest, AddObserver) {
     Arena arena;
     auto observer = std::make_shared<ConsoleObserver>();
@@ -176,6 +248,112 @@ TEST(ArenaTest, AddFileObserver) {
     std::remove("test_observer.txt");
 }
 
+// Наблюдатель, запоминающий события и размеры пачек
+class BatchRecorder : public Observer {
+    public:
+        std::vector<std::string> events;
+        std::vector<size_t> batches;
+
+        void notify(const std::string& event) override {
+            events.push_back(event);
+        }
+
+        void notifyBatch(std::span<const Event> batch) override {
+            batches.push_back(batch.size());
+            Observer::notifyBatch(batch);
+        }
+};
+
+namespace {
+
+// Три пары Dragon-Elf на расстоянии 1 друг от друга, далеко от остальных
+Arena makeThreeFightsArena() {
+    Arena arena;
+    for (int i = 0; i < 3; ++i) {
+        int x = 100 * i;
+        arena.createAndAddNpc("Dragon", "Dragon" + std::to_string(i), x, 0);
+        arena.createAndAddNpc("Elf", "Elf" + std::to_string(i), x + 1, 0);
+    }
+    return arena;
+}
+
+}
+
+TEST(ArenaTest, EventsDeliveredInBatches) {
+    Arena arena = makeThreeFightsArena();
+    auto recorder = std::make_shared<BatchRecorder>();
+    arena.addObserver(recorder);
+    arena.setEventBatchSize(2);
+    EXPECT_EQ(arena.getEventBatchSize(), 2u);
+
+    BattleResult result = arena.startBattle(5);
+
+    EXPECT_EQ(result.fights, 3u);
+    EXPECT_EQ(recorder->batches, (std::vector<size_t>{2, 1}));
+    ASSERT_EQ(recorder->events.size(), 3u);
+    EXPECT_EQ(recorder->events[0], "Dragon0 (Dragon) killed Elf0 (Elf)");
+}
+
+TEST(ArenaTest, WholeBattleInOneBatch) {
+    Arena arena = makeThreeFightsArena();
+    auto recorder = std::make_shared<BatchRecorder>();
+    arena.addObserver(recorder);
+    arena.setEventBatchSize(0);
+
+    arena.startBattle(5);
+
+    EXPECT_EQ(recorder->batches, (std::vector<size_t>{3}));
+}
+
+TEST(ArenaTest, NoBatchWithoutEvents) {
+    Arena arena;
+    arena.createAndAddNpc("Dragon", "Smaug", 0, 0);
+    auto recorder = std::make_shared<BatchRecorder>();
+    arena.addObserver(recorder);
+
+    arena.startBattle(5);
+
+    EXPECT_TRUE(recorder->batches.empty());
+}
+
+TEST(ArenaTest, DefaultBatchForwardsToNotify) {
+    // Наблюдатель только с notify получает каждое событие отдельно
+    struct Counter : Observer {
+        int calls = 0;
+        void notify(const std::string&) override {
+            calls++;
+        }
+    };
+    Arena arena = makeThreeFightsArena();
+    auto counter = std::make_shared<Counter>();
+    arena.addObserver(counter);
+
+    arena.startBattle(5);
+
+    EXPECT_EQ(counter->calls, 3);
+}
+
+TEST(ArenaTest, FileObserverWritesBatch) {
+    const std::string filename = "test_observer_batch.txt";
+    std::remove(filename.c_str());
+    Arena arena = makeThreeFightsArena();
+    arena.addObserver(std::make_shared<FileObserver>(filename));
+
+    arena.startBattle(5);
+
+    std::ifstream file(filename);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    file.close();
+    std::remove(filename.c_str());
+
+    ASSERT_EQ(lines.size(), 3u);
+    EXPECT_EQ(lines[2], "Dragon2 (Dragon) killed Elf2 (Elf)");
+}
+
 TEST(ArenaTest, PrintAllNpcs) {
     Arena arena;
     
@@ -196,3 +374,403 @@ TEST(ArenaTest, BattleNegativeRange) {
         arena.startBattle(-10.0);
     }, std::invalid_argument);
 }
+
+namespace {
+
+class CollectingSink : public DiagnosticsSink {
+    public:
+        void write(DiagLevel level, const std::string& message) override {
+            messages.push_back({level, message});
+        }
+
+        std::vector<std::pair<DiagLevel, std::string>> messages;
+};
+
+}
+
+TEST(ArenaTest, DiagnosticsSilentByDefault) {
+    Arena arena;
+    arena.addNpc(NpcFactory::createNpc("Dragon", "Smaug", 100, 100));
+
+    testing::internal::CaptureStdout();
+    arena.startBattle(10.0);
+    arena.clear();
+    EXPECT_TRUE(testing::internal::GetCapturedStdout().empty());
+}
+
+TEST(ArenaTest, DiagnosticsFilteredByLevel) {
+    std::string filename = "test_diagnostics.txt";
+    std::ofstream outfile(filename);
+    outfile << "Dragon Smaug 100 200\n";
+    outfile << "broken line\n";
+    outfile.close();
+
+    auto sink = std::make_shared<CollectingSink>();
+    Arena arena;
+    arena.setDiagnostics(sink, DiagLevel::Warning);
+    arena.loadFromFile(filename);
+
+    ASSERT_EQ(sink->messages.size(), 1u);
+    EXPECT_EQ(sink->messages[0].first, DiagLevel::Warning);
+    EXPECT_NE(sink->messages[0].second.find("broken line"), std::string::npos);
+
+    std::remove(filename.c_str());
+}
+
+TEST(ArenaTest, StructuredResults) {
+    std::string filename = "test_results.txt";
+    std::ofstream outfile(filename);
+    outfile << "Dragon Smaug 100 100\n";
+    outfile << "\n";
+    outfile << "Elf Legolas 105 105\n";
+    outfile << "Orc Grom 1 1\n";
+    outfile << "Elf Smaug 10 10\n";
+    outfile.close();
+
+    Arena arena;
+    LoadResult loaded = arena.loadFromFile(filename);
+    EXPECT_EQ(loaded.loaded, 2u);
+    ASSERT_EQ(loaded.errors.size(), 2u);
+    EXPECT_EQ(loaded.errors[0].line, 4u);
+    EXPECT_EQ(loaded.errors[1].line, 5u);
+
+    SaveResult saved = arena.saveToFile(filename);
+    EXPECT_EQ(saved.saved, 2u);
+
+    BattleResult battle = arena.startBattle(50.0);
+    EXPECT_EQ(battle.npcsBefore, 2u);
+    EXPECT_EQ(battle.npcsAfter, 1u);
+    EXPECT_EQ(battle.fights, 1u);
+    ASSERT_EQ(battle.killed.size(), 1u);
+    EXPECT_EQ(battle.killed[0], "Legolas");
+
+    EXPECT_EQ(arena.clear(), 1u);
+
+    std::remove(filename.c_str());
+}
+
+TEST(ArenaTest, TryAddNpcReturnsErrorCodes) {
+    Arena arena(100, 100);
+
+    EXPECT_TRUE(arena.tryAddNpc(NpcFactory::createNpc("Dragon", "Smaug", 10, 10)).ok());
+    EXPECT_EQ(arena.tryAddNpc(NpcFactory::createNpc("Elf", "Smaug", 20, 20)).code,
+              NpcErrorCode::DuplicateName);
+    EXPECT_EQ(arena.tryAddNpc(NpcFactory::createNpc("Elf", "Legolas", 200, 20)).code,
+              NpcErrorCode::OutOfArenaBounds);
+    EXPECT_EQ(arena.getNpcCount(), 1u);
+}
+
+TEST(ArenaTest, ForkBattleLeavesBaseIntact) {
+    Arena base;
+    base.createAndAddNpc("Dragon", "Smaug", 100, 100);
+    base.createAndAddNpc("Elf", "Legolas", 140, 100);
+    base.createAndAddNpc("Druid", "Malfurion", 300, 300);
+
+    Arena nearFight = base.fork();
+    Arena farFight = base.fork();
+    EXPECT_EQ(nearFight.startBattle(50.0).npcsAfter, 2u);
+    // Все трое в пределах дальности: каждый убит своим охотником
+    EXPECT_EQ(farFight.startBattle(500.0).npcsAfter, 0u);
+    EXPECT_EQ(base.getNpcCount(), 3u);
+}
+
+TEST(ArenaTest, ForkCopiesOnlyChangedNpcs) {
+    Arena base;
+    base.createAndAddNpc("Dragon", "Smaug", 100, 100);
+    base.createAndAddNpc("Elf", "Legolas", 140, 100);
+
+    auto addresses = [](const Arena& arena) {
+        std::vector<const Npc*> result;
+        arena.forEachNpc([&](const Npc& npc) { result.push_back(&npc); });
+        return result;
+    };
+
+    Arena fork = base.fork();
+    EXPECT_EQ(addresses(fork), addresses(base));
+
+    fork.moveNpc("Smaug", 10, 10);
+    auto forkNpcs = addresses(fork);
+    auto baseNpcs = addresses(base);
+    // Порядок имён: Legolas, Smaug
+    EXPECT_EQ(forkNpcs[0], baseNpcs[0]);
+    EXPECT_NE(forkNpcs[1], baseNpcs[1]);
+    EXPECT_EQ(baseNpcs[1]->getX(), 100);
+    EXPECT_EQ(forkNpcs[1]->getX(), 10);
+    EXPECT_EQ(forkNpcs[1]->getType(), "Dragon");
+
+    fork.createAndAddNpc("Druid", "Malfurion", 300, 300);
+    base.removeNpc("Legolas");
+    EXPECT_EQ(fork.getNpcCount(), 3u);
+    EXPECT_EQ(base.getNpcCount(), 1u);
+}
+
+TEST(ArenaTest, ForkChangesCostOnlyTheirSize) {
+    if (!allocationCountingEnabled()) GTEST_SKIP() << "allocation counting disabled at build time";
+
+    const char* types[] = {"Dragon", "Elf", "Druid"};
+    Arena base;
+    std::vector<std::string> names;
+    for (int i = 0; i < 20000; ++i) {
+        names.push_back("Npc" + std::to_string(i));
+        base.createAndAddNpc(types[i % 3], names.back(), i % 500, (i / 500) % 500);
+    }
+
+    // Копия индекса по именам стоила бы не меньше 20000 выделений
+    std::uint64_t before = allocationCount();
+    Arena fork = base.fork();
+    for (int k = 0; k < 10; ++k) {
+        EXPECT_TRUE(fork.removeNpc(names[k * 1000]));
+        fork.moveNpc(names[k * 1000 + 1], 1, 450);
+    }
+    std::uint64_t allocations = allocationCount() - before;
+    EXPECT_LT(allocations, 200u);
+
+    EXPECT_EQ(fork.getNpcCount(), 19990u);
+    EXPECT_EQ(base.getNpcCount(), 20000u);
+    size_t moved = 0;
+    fork.forEachNpc([&moved](const Npc& npc) {
+        if (npc.getY() == 450) moved++;
+    });
+    EXPECT_EQ(moved, 10u);
+}
+
+TEST(ArenaTest, ForkChangesMergeBackWhenBaseIsAlone) {
+    using Row = std::tuple<std::string, std::string, int, int>;
+    auto rows = [](const Arena& arena) {
+        std::vector<Row> result;
+        arena.forEachNpc([&result](const Npc& npc) {
+            result.emplace_back(npc.getName(), npc.getType(), npc.getX(), npc.getY());
+        });
+        return result;
+    };
+
+    Arena fork;
+    {
+        Arena base;
+        base.createAndAddNpc("Dragon", "A", 10, 10);
+        base.createAndAddNpc("Elf", "B", 20, 20);
+        base.createAndAddNpc("Druid", "C", 30, 30);
+
+        fork = base.fork();
+        fork.removeNpc("B");
+        fork.createAndAddNpc("Dragon", "B", 40, 40);
+        fork.moveNpc("A", 5, 5);
+        fork.removeNpc("C");
+        fork.createAndAddNpc("Elf", "D", 50, 50);
+        EXPECT_THROW(fork.createAndAddNpc("Elf", "A", 1, 1), std::invalid_argument);
+        EXPECT_FALSE(fork.removeNpc("C"));
+
+        Arena nested = fork.fork();
+        nested.moveNpc("B", 0, 0);
+        EXPECT_EQ(rows(nested), (std::vector<Row>{{"A", "Dragon", 5, 5}, {"B", "Dragon", 0, 0},
+                                                  {"D", "Elf", 50, 50}}));
+        EXPECT_EQ(rows(base), (std::vector<Row>{{"A", "Dragon", 10, 10}, {"B", "Elf", 20, 20},
+                                                {"C", "Druid", 30, 30}}));
+    }
+
+    // Форков не осталось: накопленные изменения переносятся в основу
+    fork.moveNpc("D", 60, 60);
+    fork.createAndAddNpc("Druid", "C", 70, 70);
+    EXPECT_EQ(rows(fork), (std::vector<Row>{{"A", "Dragon", 5, 5}, {"B", "Dragon", 40, 40},
+                                            {"C", "Druid", 70, 70}, {"D", "Elf", 60, 60}}));
+    EXPECT_EQ(fork.getNpcCount(), 4u);
+}
+
+TEST(ArenaTest, ForksRunInParallel) {
+    const char* types[] = {"Dragon", "Elf", "Druid"};
+    Arena base;
+    for (int i = 0; i < 300; ++i) {
+        base.createAndAddNpc(types[i % 3], "Npc" + std::to_string(i), (i * 37) % 500, (i * 91) % 500);
+    }
+
+    std::vector<double> ranges = {5.0, 20.0, 50.0, 150.0};
+    std::vector<size_t> expected;
+    for (double range : ranges) {
+        expected.push_back(base.fork().startBattle(range).npcsAfter);
+    }
+
+    std::vector<size_t> actual(ranges.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        threads.emplace_back([&, i] {
+            Arena fork = base.fork();
+            fork.moveNpc("Npc0", 250, 250);
+            fork.moveNpc("Npc0", (0 * 37) % 500, (0 * 91) % 500);
+            actual[i] = fork.startBattle(ranges[i]).npcsAfter;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(actual, expected);
+    EXPECT_EQ(base.getNpcCount(), 300u);
+}
+
+TEST(ArenaTest, SweepMatchesIndividualBattles) {
+    const char* types[] = {"Dragon", "Elf", "Druid"};
+    Arena arena;
+    for (int i = 0; i < 400; ++i) {
+        arena.createAndAddNpc(types[(i * 7) % 3], "Npc" + std::to_string(i),
+                              (i * 37) % 200, (i * 53) % 200);
+    }
+
+    std::vector<double> ranges = {30.0, 0.0, 5.0, 12.5, 5.0, 300.0};
+    std::vector<BattleResult> sweep = arena.sweepBattleRanges(ranges);
+    ASSERT_EQ(sweep.size(), ranges.size());
+    EXPECT_EQ(arena.getNpcCount(), 400u);
+
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        BattleResult single = arena.fork().startBattle(ranges[i]);
+        EXPECT_DOUBLE_EQ(sweep[i].range, ranges[i]);
+        EXPECT_EQ(sweep[i].npcsBefore, single.npcsBefore);
+        EXPECT_EQ(sweep[i].npcsAfter, single.npcsAfter) << ranges[i];
+        EXPECT_EQ(sweep[i].fights, single.fights) << ranges[i];
+        EXPECT_EQ(sweep[i].killed, single.killed) << ranges[i];
+    }
+}
+
+TEST(ArenaTest, SweepRejectsNegativeRange) {
+    Arena arena;
+    EXPECT_THROW(arena.sweepBattleRanges({10.0, -1.0}), std::invalid_argument);
+    EXPECT_TRUE(arena.sweepBattleRanges({}).empty());
+}
+
+namespace {
+
+// Строки сохранения арены, записанные в порядке хранения
+class LinesSink : public TextSink {
+    public:
+        std::string text;
+
+        void write(const char* data, std::size_t size) override {
+            text.append(data, size);
+        }
+
+        std::vector<std::string> lines() const {
+            std::vector<std::string> result;
+            std::istringstream in(text);
+            std::string line;
+            while (std::getline(in, line)) {
+                result.push_back(line);
+            }
+            return result;
+        }
+};
+
+std::vector<std::string> storedLines(const Arena& arena) {
+    LinesSink sink;
+    arena.writeNpcs(sink);
+    return sink.lines();
+}
+
+void expectMortonSorted(const std::vector<std::string>& lines) {
+    std::uint32_t previous = 0;
+    for (const auto& line : lines) {
+        std::istringstream in(line);
+        std::string type, name;
+        int x = 0, y = 0;
+        in >> type >> name >> x >> y;
+        std::uint32_t key = mortonKey(static_cast<std::uint16_t>(x), static_cast<std::uint16_t>(y));
+        EXPECT_LE(previous, key) << line;
+        previous = key;
+    }
+}
+
+}
+
+TEST(ArenaTest, MortonOrderKeptAcrossIncrementalChanges) {
+    const char* types[] = {"Dragon", "Elf", "Druid"};
+    Arena arena;
+    arena.setStorageOrder(StorageOrder::Morton);
+    for (int i = 0; i < 300; ++i) {
+        arena.createAndAddNpc(types[i % 3], "Npc" + std::to_string(i), (i * 37) % 500, (i * 91) % 500);
+    }
+    expectMortonSorted(storedLines(arena));
+
+    for (int i = 0; i < 300; i += 7) {
+        arena.moveNpc("Npc" + std::to_string(i), (i * 13) % 500, (i * 17) % 500);
+    }
+    for (int i = 1; i < 300; i += 11) {
+        arena.removeNpc("Npc" + std::to_string(i));
+    }
+    arena.createAndAddNpc("Dragon", "Late", 250, 250);
+    auto lines = storedLines(arena);
+    expectMortonSorted(lines);
+    EXPECT_EQ(lines.size(), arena.getNpcCount());
+
+    // Та же арена, собранная с нуля, хранится в том же порядке
+    Arena rebuilt = arena.fork();
+    rebuilt.setStorageOrder(StorageOrder::Name);
+    rebuilt.setStorageOrder(StorageOrder::Morton);
+    EXPECT_EQ(storedLines(rebuilt), lines);
+}
+
+TEST(ArenaTest, MortonOrderBattleMatchesNameOrder) {
+    const char* types[] = {"Dragon", "Elf", "Druid"};
+    Arena byName;
+    for (int i = 0; i < 400; ++i) {
+        byName.createAndAddNpc(types[(i * 7) % 3], "Npc" + std::to_string(i),
+                               (i * 37) % 200, (i * 53) % 200);
+    }
+    Arena byMorton = byName.fork();
+    byMorton.setStorageOrder(StorageOrder::Morton);
+
+    auto sweepByName = byName.sweepBattleRanges({4.0, 9.0});
+    auto sweepByMorton = byMorton.sweepBattleRanges({4.0, 9.0});
+    for (size_t i = 0; i < sweepByName.size(); ++i) {
+        EXPECT_EQ(sweepByMorton[i].killed, sweepByName[i].killed);
+    }
+
+    for (double range : {4.0, 9.0}) {
+        BattleResult expected = byName.startBattle(range);
+        BattleResult actual = byMorton.startBattle(range);
+        EXPECT_EQ(actual.fights, expected.fights);
+        EXPECT_EQ(actual.killed, expected.killed);
+        EXPECT_EQ(actual.npcsAfter, expected.npcsAfter);
+    }
+    auto lines = storedLines(byMorton);
+    EXPECT_EQ(lines.size(), byMorton.getNpcCount());
+    expectMortonSorted(lines);
+}
+
+TEST(ArenaTest, MortonOrderSharedByForksAndConcurrentReaders) {
+    const char* types[] = {"Dragon", "Elf", "Druid"};
+    Arena base;
+    base.setStorageOrder(StorageOrder::Morton);
+    for (int i = 0; i < 2000; ++i) {
+        base.createAndAddNpc(types[i % 3], "Npc" + std::to_string(i), (i * 37) % 500, (i * 91) % 500);
+    }
+    // Изменения остаются отдельно от отсортированной части
+    for (int i = 1; i < 2000; i += 100) {
+        base.removeNpc("Npc" + std::to_string(i));
+        base.moveNpc("Npc" + std::to_string(i + 2), (i * 13) % 500, (i * 17) % 500);
+    }
+    const auto expected = storedLines(base);
+    expectMortonSorted(expected);
+
+    // Константные методы только читают: потоки обходят одну арену и снимают форки
+    std::vector<std::vector<std::string>> seen(4);
+    std::vector<std::vector<std::string>> forked(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < seen.size(); ++t) {
+        threads.emplace_back([&, t] {
+            seen[t] = storedLines(base);
+            Arena fork = base.fork();
+            fork.moveNpc("Npc5", 0, 0);
+            fork.removeNpc("Npc6");
+            forked[t] = storedLines(fork);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (size_t t = 0; t < seen.size(); ++t) {
+        EXPECT_EQ(seen[t], expected);
+        EXPECT_EQ(forked[t], forked[0]);
+    }
+    EXPECT_EQ(forked[0].size(), expected.size() - 1);
+    expectMortonSorted(forked[0]);
+    EXPECT_NE(std::find(forked[0].begin(), forked[0].end(), "Druid Npc5 0 0"), forked[0].end());
+    EXPECT_EQ(storedLines(base), expected);
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "../include/async_task.h"
+#include <stdexcept>
+#include <string>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+Task<int> answer() {
+    co_return 42;
+}
+
+Task<int> answerOnPool(ThreadPool& pool) {
+    co_await schedule(pool);
+    co_return 42;
+}
+
+Task<std::thread::id> threadOnPool(ThreadPool& pool) {
+    co_await schedule(pool);
+    co_return std::this_thread::get_id();
+}
+
+Task<int> sum(ThreadPool& pool) {
+    int total = co_await answer();
+    total += co_await answerOnPool(pool);
+    co_return total;
+}
+
+Task<> fails(ThreadPool& pool) {
+    co_await schedule(pool);
+    throw std::runtime_error("disk is full");
+}
+
+Task<std::string> startedEarly(ThreadPool& pool) {
+    Task<int> background = answerOnPool(pool);
+    background.start();
+    // Задача могла завершиться до co_await - результат не теряется
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    int value = co_await background;
+    co_return std::to_string(value);
+}
+
+}
+
+TEST(AsyncTaskTest, SynchronousTaskCompletesInline) {
+    EXPECT_EQ(syncWait(answer()), 42);
+}
+
+TEST(AsyncTaskTest, ScheduleMovesToPoolThread) {
+    ThreadPool pool(1);
+    EXPECT_NE(syncWait(threadOnPool(pool)), std::this_thread::get_id());
+    EXPECT_EQ(syncWait(sum(pool)), 84);
+}
+
+TEST(AsyncTaskTest, ExceptionReachesAwaiter) {
+    ThreadPool pool(1);
+    EXPECT_THROW(syncWait(fails(pool)), std::runtime_error);
+}
+
+TEST(AsyncTaskTest, StartedTaskCanBeAwaitedLater) {
+    ThreadPool pool(2);
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(syncWait(startedEarly(pool)), "42");
+    }
+}
+
+TEST(AsyncTaskTest, UnstartedTaskIsDestroyedSafely) {
+    ThreadPool pool(1);
+    {
+        Task<int> never = answerOnPool(pool);
+    }
+    pool.waitIdle();
+    SUCCEED();
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "../include/batch_runner.h"
+#include "../include/thread_pool.h"
+#include <atomic>
+#include <fstream>
+#include <stdexcept>
+
+TEST(ThreadPoolTest, RunsAllTasks) {
+    ThreadPool pool(4);
+    std::atomic<int> counter{0};
+    for (int i = 0; i < 1000; ++i) {
+        pool.submit([&counter] { counter++; });
+    }
+    pool.waitIdle();
+    EXPECT_EQ(counter.load(), 1000);
+}
+
+TEST(ThreadPoolTest, NestedSubmitAndWorkerIndex) {
+    ThreadPool pool(3);
+    std::atomic<int> counter{0};
+    std::atomic<bool> badIndex{false};
+    for (int i = 0; i < 50; ++i) {
+        pool.submit([&] {
+            for (int j = 0; j < 10; ++j) {
+                pool.submit([&] {
+                    int worker = ThreadPool::currentWorker();
+                    if (worker < 0 || worker >= 3) badIndex = true;
+                    counter++;
+                });
+            }
+        });
+    }
+    pool.waitIdle();
+    EXPECT_EQ(counter.load(), 500);
+    EXPECT_FALSE(badIndex.load());
+    EXPECT_EQ(ThreadPool::currentWorker(), -1);
+}
+
+TEST(ThreadPoolTest, RethrowsTaskError) {
+    ThreadPool pool(2);
+    pool.submit([] { throw std::runtime_error("task failed"); });
+    EXPECT_THROW(pool.waitIdle(), std::runtime_error);
+}
+
+TEST(BatchRunnerTest, ResultIndependentOfThreadCount) {
+    auto jobs = BatchRunner::generateJobs(40, 60, {10.0, 100.0}, 7);
+
+    BatchSummary single = BatchRunner(1).run(jobs);
+    BatchSummary parallel = BatchRunner(4).run(jobs);
+
+    ASSERT_EQ(single.ranges.size(), 2u);
+    ASSERT_EQ(parallel.ranges.size(), 2u);
+    for (size_t r = 0; r < single.ranges.size(); ++r) {
+        EXPECT_EQ(single.ranges[r].battles, 40u);
+        EXPECT_EQ(single.ranges[r].fights, parallel.ranges[r].fights);
+        for (size_t kind = 0; kind < kNpcKindCount; ++kind) {
+            EXPECT_EQ(single.ranges[r].kinds[kind].initial, parallel.ranges[r].kinds[kind].initial);
+            EXPECT_EQ(single.ranges[r].kinds[kind].survived, parallel.ranges[r].kinds[kind].survived);
+        }
+    }
+}
+
+TEST(BatchRunnerTest, LargerRangeKillsMore) {
+    auto jobs = BatchRunner::generateJobs(20, 100, {5.0, 200.0}, 3);
+    BatchSummary summary = BatchRunner(2).run(jobs);
+
+    ASSERT_EQ(summary.ranges.size(), 2u);
+    EXPECT_DOUBLE_EQ(summary.ranges[0].range, 5.0);
+    EXPECT_LT(summary.ranges[0].fights, summary.ranges[1].fights);
+
+    size_t initial = 0;
+    for (const auto& kind : summary.ranges[0].kinds) {
+        initial += kind.initial;
+    }
+    EXPECT_EQ(initial, 20u * 100u);
+}
+
+TEST(BatchRunnerTest, FileJobsAndFailures) {
+    std::string filename = "test_batch_input.txt";
+    std::ofstream outfile(filename);
+    outfile << "Dragon Smaug 100 100\n";
+    outfile << "Elf Legolas 105 105\n";
+    // Пропускаются, как при Arena::loadFromFile
+    outfile << "Dragon Broken abc 10\n";
+    outfile << "Orc Grom 10 10\n";
+    outfile << "Elf Smaug 300 300\n";
+    outfile << "\n";
+    outfile.close();
+
+    BatchJob good;
+    good.sourceFile = filename;
+    good.ranges = {50.0};
+    BatchJob missing;
+    missing.sourceFile = "no_such_batch_file.txt";
+    missing.ranges = {50.0};
+
+    BatchSummary summary = BatchRunner(2).run({good, missing});
+    EXPECT_EQ(summary.jobs, 2u);
+    EXPECT_EQ(summary.failedJobs, 1u);
+    ASSERT_EQ(summary.ranges.size(), 1u);
+    auto dragon = static_cast<size_t>(NpcKind::Dragon);
+    auto elf = static_cast<size_t>(NpcKind::Elf);
+    EXPECT_EQ(summary.ranges[0].kinds[dragon].survived, 1u);
+    EXPECT_EQ(summary.ranges[0].kinds[elf].survived, 0u);
+
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include "../include/battle_log.h"
+#include "../include/arena.h"
+#include <csignal>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+namespace {
+
+const std::string kLogFile = "test_battle_log.bin";
+
+// Три пары Dragon-Elf на расстоянии 1 друг от друга, далеко от остальных
+void addThreeFights(Arena& arena) {
+    for (int i = 0; i < 3; ++i) {
+        int x = 100 * i;
+        arena.createAndAddNpc("Dragon", "Dragon" + std::to_string(i), x, 0);
+        arena.createAndAddNpc("Elf", "Elf" + std::to_string(i), x + 1, 0);
+    }
+}
+
+std::vector<std::string> names(const BattleLogReader& reader,
+                               const std::vector<BattleLogRecord>& records) {
+    std::vector<std::string> result;
+    for (const BattleLogRecord& record : records) {
+        result.push_back(std::string(reader.name(record.first)) + ">" +
+                         std::string(reader.name(record.second)));
+    }
+    return result;
+}
+
+}
+
+TEST(BattleLogTest, IndexesBattlesOfArena) {
+    {
+        Arena arena;
+        addThreeFights(arena);
+        auto log = std::make_shared<BattleLogObserver>(kLogFile);
+        arena.addObserver(log);
+
+        arena.startBattle(5);
+        arena.createAndAddNpc("Elf", "Late", 0, 1);
+        arena.startBattle(2);
+        arena.startBattle(2);
+        EXPECT_EQ(log->getRecordCount(), 4u);
+    }
+
+    BattleLogReader reader(kLogFile);
+    ASSERT_EQ(reader.getBattleCount(), 3u);
+    EXPECT_EQ(reader.getRecordCount(), 4u);
+    EXPECT_DOUBLE_EQ(reader.battle(0).range, 5.0);
+    EXPECT_DOUBLE_EQ(reader.battle(1).range, 2.0);
+
+    auto first = reader.battleRecords(0);
+    ASSERT_EQ(first.size(), 3u);
+    EXPECT_EQ(reader.name(first[2].first), "Dragon2");
+    EXPECT_EQ(first[2].firstKind, NpcKind::Dragon);
+    EXPECT_EQ(first[2].secondKind, NpcKind::Elf);
+    EXPECT_EQ(first[2].battle, 0u);
+
+    auto second = reader.battleRecords(1);
+    ASSERT_EQ(second.size(), 1u);
+    EXPECT_EQ(reader.name(second[0].second), "Late");
+    EXPECT_TRUE(reader.battleRecords(2).empty());
+
+    EXPECT_EQ(reader.battleOfRecord(0), 0u);
+    EXPECT_EQ(reader.battleOfRecord(3), 1u);
+    EXPECT_THROW(reader.battleOfRecord(4), std::out_of_range);
+    EXPECT_THROW(reader.battle(3), std::out_of_range);
+
+    std::remove(kLogFile.c_str());
+}
+
+TEST(BattleLogTest, NpcHistoryAcrossBattles) {
+    {
+        Arena arena;
+        addThreeFights(arena);
+        auto log = std::make_shared<BattleLogObserver>(kLogFile);
+        arena.addObserver(log);
+        arena.startBattle(5);
+        arena.createAndAddNpc("Elf", "Late", 0, 1);
+        arena.startBattle(2);
+        log->close();
+    }
+
+    BattleLogReader reader(kLogFile);
+    EXPECT_EQ(names(reader, reader.npcRecords("Dragon0")),
+              (std::vector<std::string>{"Dragon0>Elf0", "Dragon0>Late"}));
+    EXPECT_EQ(names(reader, reader.npcRecords("Elf1")),
+              (std::vector<std::string>{"Dragon1>Elf1"}));
+    EXPECT_TRUE(reader.npcRecords("Nobody").empty());
+    EXPECT_EQ(reader.findName("Nobody"), NameTable::kNoName);
+    EXPECT_EQ(reader.name(reader.findName("Late")), "Late");
+
+    std::remove(kLogFile.c_str());
+}
+
+TEST(BattleLogTest, GrowsBeyondInitialMapping) {
+    // Больше мегабайта записей - файл несколько раз отображается заново
+    const int fights = 100000;
+    std::vector<std::string> npcNames;
+    for (int i = 0; i <= fights; ++i) {
+        npcNames.push_back("Npc" + std::to_string(i));
+    }
+    {
+        BattleLogObserver log(kLogFile);
+        for (int battle = 0; battle < 2; ++battle) {
+            log.battleStarted(battle + 1);
+            std::vector<FightEvent> batch;
+            for (int i = 0; i < fights / 2; ++i) {
+                int loser = battle * fights / 2 + i + 1;
+                batch.push_back({npcNames[0], npcNames[loser], NpcKind::Dragon, NpcKind::Elf, false});
+            }
+            log.notifyFights(batch);
+            log.battleFinished();
+        }
+        log.battleStarted(3);
+        FightEvent mutual{npcNames[1], npcNames[2], NpcKind::Elf, NpcKind::Druid, true};
+        log.notifyFights({&mutual, 1});
+    }
+
+    BattleLogReader reader(kLogFile);
+    EXPECT_EQ(reader.getBattleCount(), 3u);
+    EXPECT_EQ(reader.getRecordCount(), static_cast<size_t>(fights + 1));
+    EXPECT_EQ(reader.npcRecords("Npc0").size(), static_cast<size_t>(fights));
+    EXPECT_EQ(reader.battleOfRecord(fights / 2), 1u);
+
+    auto history = reader.npcRecords("Npc2");
+    ASSERT_EQ(history.size(), 2u);
+    EXPECT_EQ(history[0].mutual, 0);
+    EXPECT_EQ(history[1].mutual, 1);
+    EXPECT_EQ(history[1].battle, 2u);
+
+    std::remove(kLogFile.c_str());
+}
+
+TEST(BattleLogTest, RejectsForeignAndUnfinishedFiles) {
+    {
+        std::ofstream file(kLogFile);
+        file << "Dragon Smaug 100 100\n";
+    }
+    EXPECT_THROW(BattleLogReader reader(kLogFile), std::runtime_error);
+    EXPECT_THROW(BattleLogReader reader("no_such_battle_log.bin"), std::runtime_error);
+
+    // Незакрытый журнал: записи есть, индексов ещё нет
+    BattleLogObserver log(kLogFile);
+    log.battleStarted(1);
+    EXPECT_THROW(BattleLogReader reader(kLogFile), std::runtime_error);
+
+    log.close();
+    EXPECT_EQ(BattleLogReader(kLogFile).getBattleCount(), 1u);
+    EXPECT_THROW(log.battleStarted(1), std::logic_error);
+
+    std::remove(kLogFile.c_str());
+}
+
+TEST(BattleLogTest, RejectsBrokenSectionReferences) {
+    {
+        BattleLogObserver log(kLogFile);
+        log.battleStarted(1);
+        std::vector<FightEvent> events(3, FightEvent{"Smaug", "Legolas", NpcKind::Dragon, NpcKind::Elf, true});
+        log.notifyFights(events);
+        log.close();
+    }
+    BattleLogHeader header{};
+    {
+        std::ifstream file(kLogFile, std::ios::binary);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    }
+    std::string original;
+    {
+        std::ifstream file(kLogFile, std::ios::binary);
+        original.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    // Каждая порча записывается в целую копию журнала
+    auto corrupt = [&](std::uint64_t offset, std::uint64_t value, size_t bytes) {
+        std::string broken = original;
+        std::memcpy(broken.data() + offset, &value, bytes);
+        std::ofstream file(kLogFile, std::ios::binary | std::ios::trunc);
+        file.write(broken.data(), static_cast<std::streamsize>(broken.size()));
+    };
+
+    corrupt(header.battlesOffset + offsetof(BattleLogBattle, recordCount), header.recordCount + 1, 8);
+    EXPECT_THROW(BattleLogReader reader(kLogFile), std::runtime_error);
+    corrupt(header.battlesOffset + offsetof(BattleLogBattle, firstRecord), ~std::uint64_t(0), 8);
+    EXPECT_THROW(BattleLogReader reader(kLogFile), std::runtime_error);
+    corrupt(header.npcIndexOffset + offsetof(BattleLogNpcEntry, record), header.recordCount, 8);
+    EXPECT_THROW(BattleLogReader reader(kLogFile), std::runtime_error);
+    corrupt(header.namesOffset + sizeof(std::uint32_t), 0xFFFFu, 4);
+    EXPECT_THROW(BattleLogReader reader(kLogFile), std::runtime_error);
+
+    corrupt(0, header.magic[0], 1);
+    EXPECT_EQ(BattleLogReader(kLogFile).npcRecords("Smaug").size(), 3u);
+    std::remove(kLogFile.c_str());
+}
+
+TEST(BattleLogTest, FailedGrowthKeepsLogUsable) {
+    // Предел размера файла 2 МиБ: второе удвоение отображения не удаётся
+    rlimit saved{};
+    ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &saved), 0);
+    rlimit limited = saved;
+    limited.rlim_cur = 2 << 20;
+    if (saved.rlim_max != RLIM_INFINITY && saved.rlim_max < limited.rlim_cur) {
+        GTEST_SKIP() << "file size limit is already lower";
+    }
+    auto previousHandler = std::signal(SIGXFSZ, SIG_IGN);
+    ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &limited), 0);
+
+    std::vector<FightEvent> batch(200000, FightEvent{"Smaug", "Legolas", NpcKind::Dragon, NpcKind::Elf, false});
+    {
+        BattleLogObserver log(kLogFile);
+        log.battleStarted(1);
+        log.notifyFights({batch.data(), 1000});
+        EXPECT_THROW(log.notifyFights(batch), std::runtime_error);
+        EXPECT_EQ(log.getRecordCount(), 1000u);
+        // Закрытие после ошибки не обращается к снятому отображению
+        log.battleFinished();
+        log.close();
+    }
+    setrlimit(RLIMIT_FSIZE, &saved);
+    std::signal(SIGXFSZ, previousHandler);
+
+    BattleLogReader reader(kLogFile);
+    EXPECT_EQ(reader.getRecordCount(), 1000u);
+    EXPECT_EQ(reader.npcRecords("Smaug").size(), 1000u);
+    std::remove(kLogFile.c_str());
+}
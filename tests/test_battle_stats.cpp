@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include "../include/arena.h"
+#include "../include/battle_stats.h"
+#include "../include/factory.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(BattleStatsTest, NpcKindFromType) {
+    EXPECT_EQ(kindFromType("Dragon"), NpcKind::Dragon);
+    EXPECT_EQ(kindFromType("Elf"), NpcKind::Elf);
+    EXPECT_EQ(kindFromType("Druid"), NpcKind::Druid);
+    EXPECT_EQ(kindFromType("Orc"), NpcKind::Unknown);
+
+    auto dragon = NpcFactory::createNpc("Dragon", "Smaug", 0, 0);
+    EXPECT_EQ(dragon->getKind(), NpcKind::Dragon);
+}
+
+TEST(BattleStatsTest, RecordsPairsAndKills) {
+    if (!ARENA_ENABLE_STATS) GTEST_SKIP() << "stats disabled at build time";
+
+    Arena arena;
+    arena.setSpatialBackend(SpatialBackend::BruteForce);
+    arena.addNpc(NpcFactory::createNpc("Dragon", "Smaug", 100, 100));
+    arena.addNpc(NpcFactory::createNpc("Elf", "Legolas", 105, 105));
+    arena.addNpc(NpcFactory::createNpc("Druid", "Malfurion", 110, 110));
+    arena.addNpc(NpcFactory::createNpc("Elf", "Faraway", 400, 400));
+
+    arena.startBattle(20.0);
+    const BattleStats& stats = arena.getLastBattleStats();
+
+    EXPECT_DOUBLE_EQ(stats.range, 20.0);
+    EXPECT_EQ(stats.backend, "BruteForce");
+    EXPECT_EQ(stats.npcsBefore, 4u);
+    EXPECT_EQ(stats.npcsAfter, 1u);
+    // Пара двух эльфов отсеивается по видам без вычисления расстояния
+    EXPECT_EQ(stats.pairsConsidered, 5u);
+    EXPECT_EQ(stats.pairsInRange, 3u);
+    EXPECT_EQ(stats.fights, 3u);
+
+    auto dragon = static_cast<size_t>(NpcKind::Dragon);
+    auto elf = static_cast<size_t>(NpcKind::Elf);
+    auto druid = static_cast<size_t>(NpcKind::Druid);
+    EXPECT_EQ(stats.kills[dragon][elf], 1u);
+    EXPECT_EQ(stats.kills[elf][druid], 1u);
+    EXPECT_EQ(stats.kills[druid][dragon], 1u);
+    EXPECT_EQ(stats.totalKills(), 3u);
+}
+
+TEST(BattleStatsTest, JsonContainsAllSections) {
+    if (!ARENA_ENABLE_STATS) GTEST_SKIP() << "stats disabled at build time";
+
+    Arena arena;
+    arena.addNpc(NpcFactory::createNpc("Dragon", "Smaug", 100, 100));
+    arena.addNpc(NpcFactory::createNpc("Elf", "Legolas", 105, 105));
+    arena.startBattle(50.0);
+
+    std::string json = arena.getLastBattleStats().toJson();
+    EXPECT_NE(json.find("\"pairsInRange\":1"), std::string::npos);
+    EXPECT_NE(json.find("\"Dragon>Elf\":1"), std::string::npos);
+    EXPECT_NE(json.find("\"phasesNs\""), std::string::npos);
+    EXPECT_NE(json.find("\"allocations\""), std::string::npos);
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '}');
+}
+
+TEST(BattleStatsTest, JsonWritesInfiniteRangeAsNull) {
+    if (!ARENA_ENABLE_STATS) GTEST_SKIP() << "stats disabled at build time";
+
+    Arena arena;
+    arena.addNpc(NpcFactory::createNpc("Dragon", "Smaug", 100, 100));
+    arena.addNpc(NpcFactory::createNpc("Elf", "Legolas", 400, 400));
+    arena.startBattle(std::numeric_limits<double>::infinity());
+    EXPECT_EQ(arena.getNpcCount(), 1u);
+
+    std::string json = arena.getLastBattleStats().toJson();
+    EXPECT_EQ(json.rfind("{\"range\":null,", 0), 0u);
+    EXPECT_EQ(json.find("inf"), std::string::npos);
+}
+
+TEST(BattleStatsTest, StatsResetBetweenBattles) {
+    if (!ARENA_ENABLE_STATS) GTEST_SKIP() << "stats disabled at build time";
+
+    Arena arena;
+    arena.addNpc(NpcFactory::createNpc("Dragon", "Smaug", 100, 100));
+    arena.addNpc(NpcFactory::createNpc("Elf", "Legolas", 105, 105));
+    arena.startBattle(50.0);
+    arena.startBattle(50.0);
+
+    EXPECT_EQ(arena.getLastBattleStats().fights, 0u);
+    EXPECT_EQ(arena.getLastBattleStats().totalKills(), 0u);
+}
+
+TEST(BattleStatsTest, HardwareCountersOffByDefault) {
+    if (!ARENA_ENABLE_STATS) GTEST_SKIP() << "stats disabled at build time";
+
+    Arena arena;
+    EXPECT_FALSE(arena.getHardwareCountersEnabled());
+    arena.addNpc(NpcFactory::createNpc("Dragon", "Smaug", 100, 100));
+    arena.startBattle(50.0);
+
+    EXPECT_FALSE(arena.getLastBattleStats().countersTracked);
+    EXPECT_NE(arena.getLastBattleStats().toJson().find("\"counters\":null"), std::string::npos);
+}
+
+TEST(BattleStatsTest, HardwareCountersPerPhase) {
+    if (!ARENA_ENABLE_STATS) GTEST_SKIP() << "stats disabled at build time";
+
+    Arena arena;
+    arena.setHardwareCountersEnabled(true);
+    for (int i = 0; i < 200; ++i) {
+        arena.createAndAddNpc(i % 2 ? "Elf" : "Dragon", "Npc" + std::to_string(i), i, i);
+    }
+    arena.startBattle(3.0);
+    const BattleStats& stats = arena.getLastBattleStats();
+    EXPECT_TRUE(stats.countersTracked);
+
+    // Без доступа к perf (контейнер, perf_event_paranoid) счётчики пустые,
+    // а в JSON вместо значений null
+    std::string json = stats.toJson();
+    EXPECT_NE(json.find("\"counters\":{\"candidates\":{\"cycles\":"), std::string::npos);
+    EXPECT_NE(json.find("\"removal\":{"), std::string::npos);
+    if (PerfCounters().available()) {
+        if (stats.combatCounters.has(HardwareCounter::Instructions)) {
+            EXPECT_GT(stats.combatCounters.get(HardwareCounter::Instructions), 0u);
+        }
+    } else {
+        EXPECT_EQ(stats.candidateCounters.available, 0u);
+        EXPECT_NE(json.find("\"cycles\":null"), std::string::npos);
+    }
+}
+
+TEST(BattleStatsTest, PhaseCountersAccumulate) {
+    PhaseCounters total;
+    PhaseCounters part;
+    part.values[static_cast<size_t>(HardwareCounter::Cycles)] = 10;
+    part.available = 1u << static_cast<unsigned>(HardwareCounter::Cycles);
+    total += part;
+    total += part;
+
+    EXPECT_TRUE(total.has(HardwareCounter::Cycles));
+    EXPECT_FALSE(total.has(HardwareCounter::CacheMisses));
+    EXPECT_EQ(total.get(HardwareCounter::Cycles), 20u);
+    EXPECT_STREQ(hardwareCounterName(HardwareCounter::BranchMisses), "branchMisses");
+}
+
+TEST(BattleStatsTest, AllocationsCountOnlyBattleThread) {
+    if (!ARENA_ENABLE_STATS) GTEST_SKIP() << "stats disabled at build time";
+    if (!allocationCountingEnabled()) GTEST_SKIP() << "allocation counting disabled at build time";
+
+    auto battleAllocations = [] {
+        Arena arena;
+        for (int i = 0; i < 200; ++i) {
+            arena.createAndAddNpc(i % 2 ? "Elf" : "Dragon", "Npc" + std::to_string(i), i, i % 7);
+        }
+        arena.startBattle(5.0);
+        return arena.getLastBattleStats().allocations;
+    };
+    std::uint64_t alone = battleAllocations();
+
+    // Соседний поток всё время выделяет память; бою она не засчитывается
+    std::atomic<bool> stop{false};
+    std::thread noise([&stop] {
+        while (!stop.load(std::memory_order_relaxed)) {
+            std::vector<std::unique_ptr<int>> garbage;
+            for (int i = 0; i < 100; ++i) {
+                garbage.push_back(std::make_unique<int>(i));
+            }
+        }
+    });
+    std::uint64_t concurrent = 0;
+    for (int i = 0; i < 20; ++i) {
+        concurrent = std::max(concurrent, battleAllocations());
+    }
+    stop = true;
+    noise.join();
+
+    EXPECT_GT(alone, 0u);
+    EXPECT_EQ(concurrent, alone);
+}
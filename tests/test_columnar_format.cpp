@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include "../include/columnar_format.h"
+#include "../include/morton.h"
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+
+namespace {
+
+void fillArena(Arena& arena, size_t count, unsigned seed) {
+    static const char* kTypes[] = {"Dragon", "Elf", "Druid"};
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> coord(0, 500);
+    for (size_t i = 0; i < count; ++i) {
+        arena.createAndAddNpc(kTypes[rng() % 3], "Npc" + std::to_string(i), coord(rng), coord(rng));
+    }
+}
+
+std::map<std::string, std::tuple<std::string, int, int>> contents(const Arena& arena) {
+    std::map<std::string, std::tuple<std::string, int, int>> result;
+    arena.forEachNpc([&result](const Npc& npc) {
+        result[npc.getName()] = {npc.getType(), npc.getX(), npc.getY()};
+    });
+    return result;
+}
+
+}
+
+TEST(ColumnarFormatTest, MortonKeyInterleavesBits) {
+    EXPECT_EQ(mortonKey(0, 0), 0u);
+    EXPECT_EQ(mortonKey(1, 0), 1u);
+    EXPECT_EQ(mortonKey(0, 1), 2u);
+    EXPECT_EQ(mortonKey(3, 3), 15u);
+    EXPECT_EQ(mortonKey(500, 500), mortonKey(500, 0) | mortonKey(0, 500));
+}
+
+TEST(ColumnarFormatTest, RoundtripSequentialAndParallel) {
+    Arena arena;
+    fillArena(arena, 5000, 1);
+    size_t bytes = ColumnarFormat::save(arena, "test_columnar.bin", 256);
+    EXPECT_GT(bytes, 0u);
+
+    for (size_t threads : {1u, 4u}) {
+        Arena loaded;
+        LoadResult result = ColumnarFormat::load(loaded, "test_columnar.bin", threads);
+        EXPECT_EQ(result.loaded, 5000u);
+        EXPECT_TRUE(result.errors.empty());
+        EXPECT_EQ(contents(loaded), contents(arena));
+    }
+
+    std::remove("test_columnar.bin");
+}
+
+TEST(ColumnarFormatTest, SmallerThanTextFormat) {
+    Arena arena;
+    fillArena(arena, 5000, 2);
+    size_t columnar = ColumnarFormat::save(arena, "test_columnar.bin");
+    arena.saveToFile("test_columnar.txt");
+
+    std::ifstream text("test_columnar.txt", std::ios::binary | std::ios::ate);
+    size_t textSize = static_cast<size_t>(text.tellg());
+    EXPECT_LT(columnar * 2, textSize);
+
+    std::remove("test_columnar.bin");
+    std::remove("test_columnar.txt");
+}
+
+TEST(ColumnarFormatTest, StreamingReader) {
+    Arena arena;
+    fillArena(arena, 1000, 3);
+    ColumnarFormat::save(arena, "test_columnar.bin", 100);
+
+    ColumnarReader reader("test_columnar.bin");
+    EXPECT_EQ(reader.getBlockCount(), 10u);
+    EXPECT_EQ(reader.getNpcCount(), 1000u);
+
+    std::vector<char> block;
+    std::vector<ColumnarNpc> decoded;
+    size_t total = 0;
+    while (reader.readBlock(block)) {
+        reader.decodeBlock(block, decoded);
+        total += decoded.size();
+    }
+    EXPECT_EQ(total, 1000u);
+
+    std::remove("test_columnar.bin");
+}
+
+TEST(ColumnarFormatTest, EmptyArenaAndBadFiles) {
+    Arena empty;
+    ColumnarFormat::save(empty, "test_columnar.bin");
+    Arena loaded;
+    EXPECT_EQ(ColumnarFormat::load(loaded, "test_columnar.bin").loaded, 0u);
+
+    {
+        std::ofstream bad("test_columnar.bin");
+        bad << "Dragon Smaug 100 100\n";
+    }
+    EXPECT_THROW(ColumnarFormat::load(loaded, "test_columnar.bin"), std::runtime_error);
+    EXPECT_THROW(ColumnarFormat::load(loaded, "no_such_columnar.bin"), std::runtime_error);
+
+    std::remove("test_columnar.bin");
+}
+
+TEST(ColumnarFormatTest, CorruptLengthsRejectedBeforeAllocation) {
+    // Блок заявляет 2^40 NPC, но содержит несколько байт
+    const char hugeCount[] = {'\x80', '\x80', '\x80', '\x80', '\x80', '\x20', 0, 1, 0, 0};
+    std::vector<ColumnarNpc> decoded;
+    EXPECT_THROW(decodeColumnarBlock(hugeCount, sizeof(hugeCount), {"Dragon"}, decoded),
+                 std::runtime_error);
+
+    Arena arena;
+    fillArena(arena, 10, 3);
+    ColumnarFormat::save(arena, "test_columnar.bin");
+    std::string bytes;
+    {
+        std::ifstream in("test_columnar.bin", std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    // Заголовок: сигнатура, число NPC (10), число блоков (1), число типов (3)
+    // и типы; за ними длина единственного блока заменяется на 2^62
+    size_t blockStart = 8 + 3;
+    for (int i = 0; i < 3; ++i) {
+        blockStart += 1 + static_cast<unsigned char>(bytes[blockStart]);
+    }
+    size_t blockLengthSize = 1;
+    while (static_cast<unsigned char>(bytes[blockStart + blockLengthSize - 1]) & 0x80) ++blockLengthSize;
+    bytes.replace(blockStart, blockLengthSize, std::string(8, '\x80') + '\x40');
+    {
+        std::ofstream out("test_columnar.bin", std::ios::binary);
+        out << bytes;
+    }
+
+    ColumnarReader reader("test_columnar.bin");
+    std::vector<char> block;
+    EXPECT_THROW(reader.readBlock(block), std::runtime_error);
+
+    // Длина типа больше файла
+    bytes.resize(8 + 3);
+    bytes += std::string(8, '\xff') + '\x01';
+    {
+        std::ofstream out("test_columnar.bin", std::ios::binary);
+        out << bytes;
+    }
+    EXPECT_THROW(ColumnarReader("test_columnar.bin"), std::runtime_error);
+
+    std::remove("test_columnar.bin");
+}
@@ -4,8 +4,11 @@
 #include "../include/factory.h"
 #include "../include/console_observer.h"
 #include "../include/file_observer.h"
+#include "../include/death_set.h"
 #include <memory>
 #include <fstream>
+#include <random>
+#include <set>
 
 TEST(CombatTest, DragonVsDragon) {
     CombatVisitor visitor;
@@ -191,6 +194,63 @@ TEST(CombatTest, DragonsSurviveAlone) {
     EXPECT_EQ(arena.getNpcCount(), 3);
 }
 
+TEST(CombatTest, DeathSetMarksAndMerges) {
+    DeathSet a(130);
+    DeathSet b(130);
+    a.mark(0);
+    a.mark(64);
+    b.mark(64);
+    b.mark(129);
+    a.merge(b);
+    EXPECT_TRUE(a.contains(0));
+    EXPECT_TRUE(a.contains(129));
+    EXPECT_FALSE(a.contains(1));
+    EXPECT_EQ(a.count(), 3u);
+    EXPECT_EQ(a.size(), 130u);
+}
+
+TEST(CombatTest, OutcomeIndependentOfNameOrder) {
+    const char* types[] = {"Dragon", "Elf", "Druid"};
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> coord(0, 60);
+    std::vector<std::pair<int, int>> positions;
+    for (int i = 0; i < 200; ++i) {
+        positions.push_back({coord(rng), coord(rng)});
+    }
+
+    // Одни и те же NPC под разными именами перебираются в разном порядке
+    auto survivors = [&](bool reversed) {
+        Arena arena;
+        for (int i = 0; i < 200; ++i) {
+            int key = reversed ? 1000 - i : i;
+            arena.createAndAddNpc(types[i % 3], "Npc" + std::to_string(key),
+                                  positions[i].first, positions[i].second);
+        }
+        arena.startBattle(5.0);
+        std::set<std::pair<int, int>> alive;
+        arena.forEachNpc([&](const Npc& npc) {
+            alive.insert({npc.getX() * 1000 + npc.getY(), static_cast<int>(npc.getKind())});
+        });
+        return alive;
+    };
+
+    auto forward = survivors(false);
+    EXPECT_EQ(forward, survivors(true));
+    EXPECT_LT(forward.size(), 200u);
+}
+
+TEST(CombatTest, KilledNpcStillFightsInSameBattle) {
+    Arena arena;
+    // Эльф убит драконом, но в том же бою успевает убить друида
+    arena.addNpc(NpcFactory::createNpc("Dragon", "A", 0, 0));
+    arena.addNpc(NpcFactory::createNpc("Elf", "B", 5, 0));
+    arena.addNpc(NpcFactory::createNpc("Druid", "C", 15, 0));
+
+    BattleResult result = arena.startBattle(10.0);
+    EXPECT_EQ(result.killed, (std::vector<std::string>{"B", "C"}));
+    EXPECT_EQ(arena.getNpcCount(), 1u);
+}
+
 TEST(CombatTest, FileObserverLogging) {
     std::string logfile = "test_combat_log.txt";
     
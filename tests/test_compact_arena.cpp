@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "../include/compact_arena.h"
+#include "../include/arena.h"
+#include "../include/factory.h"
+#include <algorithm>
+#include <string>
+
+TEST(CompactArenaTest, RecordPacksIntoEightBytes) {
+    CompactNpc npc(NpcKind::Druid, 500, 499, CompactNpc::kMaxNameId);
+    EXPECT_EQ(sizeof(npc), 8u);
+    EXPECT_EQ(npc.getKind(), NpcKind::Druid);
+    EXPECT_EQ(npc.getX(), 500);
+    EXPECT_EQ(npc.getY(), 499);
+    EXPECT_EQ(npc.getNameId(), CompactNpc::kMaxNameId);
+}
+
+TEST(CompactArenaTest, NameTableInternsOnce) {
+    NameTable names;
+    std::uint32_t smaug = names.intern("Smaug");
+    for (int i = 0; i < 1000; ++i) {
+        names.intern("Npc" + std::to_string(i));
+    }
+    EXPECT_EQ(names.intern("Smaug"), smaug);
+    EXPECT_EQ(names.find("Npc999"), names.intern("Npc999"));
+    EXPECT_EQ(names.find("Nobody"), NameTable::kNoName);
+    EXPECT_EQ(names.name(smaug), "Smaug");
+    EXPECT_EQ(names.size(), 1001u);
+}
+
+TEST(CompactArenaTest, AddRemoveAndErrors) {
+    CompactArena arena;
+    arena.createAndAddNpc("Dragon", "Smaug", 100, 100);
+    arena.createAndAddNpc("Elf", "Legolas", 200, 200);
+    arena.createAndAddNpc("Druid", "Malfurion", 300, 300);
+
+    EXPECT_EQ(arena.tryAddNpc("Elf", "Smaug", 1, 1).code, NpcErrorCode::DuplicateName);
+    EXPECT_EQ(arena.tryAddNpc("Elf", "Far", 501, 1).code, NpcErrorCode::OutOfArenaBounds);
+    EXPECT_EQ(arena.tryAddNpc("Orc", "Grom", 1, 1).code, NpcErrorCode::UnknownType);
+    EXPECT_THROW(arena.createAndAddNpc("Elf", "Legolas", 1, 1), std::invalid_argument);
+
+    EXPECT_TRUE(arena.removeNpc("Smaug"));
+    EXPECT_FALSE(arena.removeNpc("Smaug"));
+    EXPECT_EQ(arena.getNpcCount(), 2u);
+    // Имя освободилось
+    EXPECT_TRUE(arena.tryAddNpc("Dragon", "Smaug", 5, 5).ok());
+    EXPECT_TRUE(arena.removeNpc("Legolas"));
+
+    std::vector<std::string> names;
+    arena.forEachNpc([&names](const CompactNpc&, std::string_view name) {
+        names.emplace_back(name);
+    });
+    std::sort(names.begin(), names.end());
+    EXPECT_EQ(names, (std::vector<std::string>{"Malfurion", "Smaug"}));
+}
+
+TEST(CompactArenaTest, BattleMatchesArena) {
+    const char* types[] = {"Dragon", "Elf", "Druid"};
+    Arena arena;
+    for (int i = 0; i < 500; ++i) {
+        arena.createAndAddNpc(types[(i * 5) % 3], "Npc" + std::to_string(i),
+                              (i * 37) % 300, (i * 91) % 300);
+    }
+    CompactArena compact = CompactArena::fromArena(arena);
+    EXPECT_EQ(compact.getNpcCount(), 500u);
+
+    for (double range : {3.0, 15.0}) {
+        BattleResult expected = arena.startBattle(range);
+        BattleResult actual = compact.startBattle(range);
+        EXPECT_EQ(actual.fights, expected.fights);
+        EXPECT_EQ(actual.killed, expected.killed);
+        EXPECT_EQ(actual.npcsAfter, expected.npcsAfter);
+    }
+    // Убитые не мешают удалению выживших по имени
+    arena.forEachNpc([&compact](const Npc& npc) {
+        EXPECT_TRUE(compact.removeNpc(npc.getName()));
+    });
+    EXPECT_EQ(compact.getNpcCount(), 0u);
+}
+
+TEST(CompactArenaTest, FromArenaKeepsArenaBounds) {
+    Arena arena(120, 80);
+    arena.createAndAddNpc("Dragon", "Smaug", 120, 80);
+    arena.createAndAddNpc("Elf", "Legolas", 0, 0);
+
+    CompactArena compact = CompactArena::fromArena(arena);
+    EXPECT_EQ(compact.getNpcCount(), 2u);
+    EXPECT_TRUE(compact.tryAddNpc("Druid", "Edge", 120, 80).ok());
+    EXPECT_EQ(compact.tryAddNpc("Druid", "Far", 121, 10).code, NpcErrorCode::OutOfArenaBounds);
+    EXPECT_EQ(compact.tryAddNpc("Druid", "Low", 10, 81).code, NpcErrorCode::OutOfArenaBounds);
+}
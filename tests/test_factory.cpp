@@ -3,7 +3,9 @@
 #include "../include/dragon.h"
 #include "../include/elf.h"
 #include "../include/druid.h"
+#include "../include/expected.h"
 #include <memory>
+#include <sstream>
 
 TEST(FactoryTest, CreateDragon) {
     auto dragon = NpcFactory::createNpc("Dragon", "Smaug", 100, 200);
@@ -99,4 +101,79 @@ TEST(FactoryTest, CreateFromStringOutOfBounds) {
     EXPECT_THROW({
         auto npc = NpcFactory::createFromString(line);
     }, std::out_of_range);
-}
\ No newline at end of file
+}
+
+// Тесты разбора строки без исключений
+TEST(FactoryTest, ParseLineValid) {
+    ParsedNpcLine parsed;
+    ParseStatus status = NpcFactory::parseLine("  Elf\tLegolas  300 +400 trailing", parsed);
+
+    EXPECT_TRUE(status.ok());
+    EXPECT_EQ(parsed.type, "Elf");
+    EXPECT_EQ(parsed.name, "Legolas");
+    EXPECT_EQ(parsed.x, 300);
+    EXPECT_EQ(parsed.y, 400);
+}
+
+TEST(FactoryTest, ParseLineErrorsWithColumn) {
+    ParsedNpcLine parsed;
+
+    EXPECT_EQ(NpcFactory::parseLine("", parsed).error, ParseError::MissingType);
+    EXPECT_EQ(NpcFactory::parseLine("Dragon", parsed).error, ParseError::MissingName);
+
+    ParseStatus badX = NpcFactory::parseLine("Dragon Smaug abc 10", parsed);
+    EXPECT_EQ(badX.error, ParseError::BadX);
+    EXPECT_EQ(badX.column, 14u);
+
+    ParseStatus badY = NpcFactory::parseLine("Dragon Smaug 10", parsed);
+    EXPECT_EQ(badY.error, ParseError::BadY);
+
+    // Как и operator>>, знак после '+' не допускается
+    EXPECT_EQ(NpcFactory::parseLine("Dragon Smaug +-5 10", parsed).error, ParseError::BadX);
+    EXPECT_EQ(NpcFactory::parseLine("Dragon Smaug 10 +-5", parsed).error, ParseError::BadY);
+    std::istringstream plusMinus("+-5");
+    int streamed = 0;
+    EXPECT_FALSE(plusMinus >> streamed);
+
+    ParseStatus overflow = NpcFactory::parseLine("Dragon Smaug 99999999999 10", parsed);
+    EXPECT_EQ(overflow.error, ParseError::BadX);
+
+    ParseStatus range = NpcFactory::parseLine("Dragon Smaug 10 501", parsed);
+    EXPECT_EQ(range.error, ParseError::OutOfRange);
+    EXPECT_EQ(range.column, 17u);
+    EXPECT_STREQ(parseErrorMessage(range.error), "coordinates out of range (0-500)");
+}
+
+TEST(FactoryTest, CreateFromStringNegativeCoordinates) {
+    EXPECT_THROW({
+        auto npc = NpcFactory::createFromString("Elf Legolas -5 10");
+    }, std::out_of_range);
+}
+
+// Тесты вариантов без исключений
+TEST(FactoryTest, TryCreateNpc) {
+    auto dragon = NpcFactory::tryCreateNpc("Dragon", "Smaug", 1, 2);
+    ASSERT_TRUE(dragon.hasValue());
+    EXPECT_EQ((*dragon)->getName(), "Smaug");
+
+    auto orc = NpcFactory::tryCreateNpc("Orc", "Grom", 1, 2);
+    EXPECT_FALSE(orc);
+    EXPECT_EQ(orc.error().code, NpcErrorCode::UnknownType);
+}
+
+TEST(FactoryTest, TryCreateFromString) {
+    auto elf = NpcFactory::tryCreateFromString("Elf Legolas 300 400");
+    ASSERT_TRUE(elf);
+    EXPECT_EQ((*elf)->getX(), 300);
+
+    auto bad = NpcFactory::tryCreateFromString("Elf Legolas");
+    EXPECT_EQ(bad.error().code, NpcErrorCode::ParseFailed);
+    EXPECT_EQ(bad.error().parse, ParseError::BadX);
+
+    auto far = NpcFactory::tryCreateFromString("Elf Legolas 600 1");
+    EXPECT_EQ(far.error().code, NpcErrorCode::CoordinatesOutOfRange);
+    EXPECT_NE(far.error().message().find("column 13"), std::string::npos);
+
+    auto unknown = NpcFactory::tryCreateFromString("Orc Grom 1 1");
+    EXPECT_EQ(unknown.error().code, NpcErrorCode::UnknownType);
+}
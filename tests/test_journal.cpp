@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include "../include/journal.h"
+#include "../include/factory.h"
+#include <fstream>
+#include <map>
+#include <string>
+
+namespace {
+
+const char* kSnapshot = "test_journal_snapshot.txt";
+const char* kJournal = "test_journal_log.txt";
+
+void removeFiles() {
+    std::remove(kSnapshot);
+    std::remove(kJournal);
+}
+
+std::map<std::string, std::pair<int, int>> positions(const Arena& arena) {
+    std::map<std::string, std::pair<int, int>> result;
+    arena.forEachNpc([&result](const Npc& npc) {
+        result[npc.getName()] = {npc.getX(), npc.getY()};
+    });
+    return result;
+}
+
+size_t countLines(const std::string& filename) {
+    std::ifstream in(filename);
+    std::string line;
+    size_t count = 0;
+    while (std::getline(in, line)) {
+        if (!line.empty()) count++;
+    }
+    return count;
+}
+
+}
+
+TEST(JournalTest, ArenaRemoveAndMove) {
+    Arena arena;
+    arena.createAndAddNpc("Dragon", "Smaug", 100, 100);
+
+    arena.moveNpc("Smaug", 10, 20);
+    EXPECT_EQ(positions(arena)["Smaug"], std::make_pair(10, 20));
+    EXPECT_THROW(arena.moveNpc("Smaug", 600, 20), std::out_of_range);
+    EXPECT_THROW(arena.moveNpc("Nobody", 1, 1), std::invalid_argument);
+
+    EXPECT_TRUE(arena.removeNpc("Smaug"));
+    EXPECT_FALSE(arena.removeNpc("Smaug"));
+    EXPECT_EQ(arena.getNpcCount(), 0u);
+}
+
+TEST(JournalTest, RecoverReplaysJournalWithoutSnapshot) {
+    removeFiles();
+    Arena arena;
+    {
+        ArenaJournal journal(arena, kSnapshot, kJournal, 0);
+        journal.createAndAddNpc("Dragon", "Smaug", 100, 100);
+        journal.createAndAddNpc("Elf", "Legolas", 105, 105);
+        journal.createAndAddNpc("Druid", "Malfurion", 400, 400);
+        journal.moveNpc("Malfurion", 300, 300);
+        journal.startBattle(50.0);
+        journal.createAndAddNpc("Elf", "Arwen", 10, 10);
+        journal.removeNpc("Arwen");
+        EXPECT_EQ(journal.getPendingRecords(), 7u);
+    }
+
+    Arena recovered;
+    EXPECT_EQ(ArenaJournal::recover(recovered, kSnapshot, kJournal), 7u);
+    EXPECT_EQ(positions(recovered), positions(arena));
+    EXPECT_EQ(recovered.getNpcCount(), 2u);
+    removeFiles();
+}
+
+TEST(JournalTest, CheckpointTruncatesJournal) {
+    removeFiles();
+    Arena arena;
+    {
+        ArenaJournal journal(arena, kSnapshot, kJournal, 0);
+        for (int i = 0; i < 20; ++i) {
+            journal.createAndAddNpc("Dragon", "Dragon" + std::to_string(i), i, i);
+        }
+        journal.checkpoint();
+        EXPECT_EQ(journal.getPendingRecords(), 0u);
+        EXPECT_EQ(countLines(kJournal), 0u);
+
+        journal.moveNpc("Dragon3", 250, 250);
+        EXPECT_EQ(countLines(kJournal), 1u);
+    }
+
+    Arena recovered;
+    EXPECT_EQ(ArenaJournal::recover(recovered, kSnapshot, kJournal), 1u);
+    EXPECT_EQ(positions(recovered), positions(arena));
+    removeFiles();
+}
+
+TEST(JournalTest, CheckpointReplacesExistingSnapshot) {
+    removeFiles();
+    Arena arena;
+    {
+        ArenaJournal journal(arena, kSnapshot, kJournal, 0);
+        journal.createAndAddNpc("Dragon", "Smaug", 10, 10);
+        journal.checkpoint();
+        journal.createAndAddNpc("Elf", "Legolas", 20, 20);
+        journal.checkpoint();
+    }
+    // Временный файл снимка не остаётся, а снимок содержит обе записи
+    EXPECT_FALSE(std::ifstream(std::string(kSnapshot) + ".tmp").good());
+    EXPECT_EQ(countLines(kSnapshot), 2u);
+    EXPECT_EQ(countLines(kJournal), 0u);
+    removeFiles();
+}
+
+TEST(JournalTest, AutomaticCheckpoint) {
+    removeFiles();
+    Arena arena;
+    ArenaJournal journal(arena, kSnapshot, kJournal, 5);
+    for (int i = 0; i < 12; ++i) {
+        journal.createAndAddNpc("Elf", "Elf" + std::to_string(i), i, i);
+    }
+    EXPECT_EQ(journal.getPendingRecords(), 2u);
+    EXPECT_EQ(countLines(kSnapshot), 10u);
+    EXPECT_EQ(countLines(kJournal), 2u);
+    removeFiles();
+}
+
+TEST(JournalTest, RecoverSkipsTornAndStaleRecords) {
+    removeFiles();
+    {
+        std::ofstream snapshot(kSnapshot);
+        snapshot << "Dragon Smaug 100 100\n";
+    }
+    {
+        std::ofstream journal(kJournal);
+        journal << "A Dragon Smaug 100 100\n";   // уже в снимке
+        journal << "M Smaug 1 2\n";
+        journal << "X unknown record\n";
+        journal << "A Elf Leg";                   // оборванная запись
+    }
+
+    Arena recovered;
+    EXPECT_EQ(ArenaJournal::recover(recovered, kSnapshot, kJournal), 1u);
+    EXPECT_EQ(recovered.getNpcCount(), 1u);
+    EXPECT_EQ(positions(recovered)["Smaug"], std::make_pair(1, 2));
+    removeFiles();
+}
+
+TEST(JournalTest, InvalidChangesAreNotJournaled) {
+    removeFiles();
+    Arena arena;
+    ArenaJournal journal(arena, kSnapshot, kJournal, 0);
+    journal.createAndAddNpc("Dragon", "Smaug", 100, 100);
+
+    EXPECT_THROW(journal.createAndAddNpc("Elf", "Smaug", 10, 10), std::invalid_argument);
+    EXPECT_THROW(journal.createAndAddNpc("Elf", "Legolas", 600, 10), std::out_of_range);
+    EXPECT_THROW(journal.moveNpc("Smaug", 10, 600), std::out_of_range);
+    EXPECT_THROW(journal.moveNpc("Nobody", 10, 10), std::invalid_argument);
+    EXPECT_FALSE(journal.removeNpc("Nobody"));
+    EXPECT_THROW(journal.startBattle(-1.0), std::invalid_argument);
+
+    EXPECT_EQ(countLines(kJournal), 1u);
+    EXPECT_EQ(journal.getPendingRecords(), 1u);
+    removeFiles();
+}
+
+TEST(JournalTest, FailedWriteLeavesArenaUnchanged) {
+    // Запись в /dev/full всегда завершается ошибкой "нет места"
+    if (!std::ofstream("/dev/full", std::ios::app)) {
+        GTEST_SKIP() << "/dev/full is not available";
+    }
+    removeFiles();
+    Arena arena;
+    arena.createAndAddNpc("Dragon", "Smaug", 100, 100);
+    arena.createAndAddNpc("Elf", "Legolas", 105, 105);
+    auto before = positions(arena);
+
+    ArenaJournal journal(arena, kSnapshot, "/dev/full", 0);
+    EXPECT_THROW(journal.createAndAddNpc("Druid", "Malfurion", 10, 10), std::runtime_error);
+    EXPECT_THROW(journal.moveNpc("Smaug", 1, 1), std::runtime_error);
+    EXPECT_THROW(journal.removeNpc("Legolas"), std::runtime_error);
+    EXPECT_THROW(journal.startBattle(50.0), std::runtime_error);
+
+    EXPECT_EQ(positions(arena), before);
+    EXPECT_EQ(journal.getPendingRecords(), 0u);
+    // Бой, прерванный до удаления погибших, можно повторить
+    EXPECT_EQ(arena.startBattle(50.0).npcsAfter, 1u);
+    removeFiles();
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "../include/npc_record.h"
+#include "../include/factory.h"
+#include "../include/dragon.h"
+#include "../include/elf.h"
+#include "../include/druid.h"
+#include <memory>
+
+namespace {
+
+class KindCounter : public RecordVisitor<KindCounter> {
+    public:
+        int dragons = 0;
+        int elves = 0;
+        int druids = 0;
+        int others = 0;
+
+        void visitDragon(NpcRecord&) { dragons++; }
+        void visitElf(NpcRecord&) { elves++; }
+        void visitDruid(NpcRecord&) { druids++; }
+        void visitOther(NpcRecord&) { others++; }
+};
+
+// Обычный посетитель иерархии: сдвигает эльфов
+class ElfMover : public Visitor {
+    public:
+        int visited = 0;
+
+        void visit(Dragon&) override { visited++; }
+        void visit(Elf& elf) override {
+            visited++;
+            elf.setPosition(elf.getX() + 1, elf.getY());
+        }
+        void visit(Druid&) override { visited++; }
+};
+
+}
+
+TEST(NpcRecordTest, RoundTripThroughHierarchy) {
+    auto npc = NpcFactory::createNpc("Druid", "Malfurion", 12, 34);
+    NpcRecord record = NpcRecord::fromNpc(*npc);
+    EXPECT_EQ(record.kind, NpcKind::Druid);
+    EXPECT_STREQ(record.type(), "Druid");
+    EXPECT_EQ(record.name, "Malfurion");
+
+    auto restored = record.toNpc();
+    EXPECT_EQ(restored->getType(), "Druid");
+    EXPECT_EQ(restored->getX(), 12);
+    EXPECT_EQ(restored->getY(), 34);
+    EXPECT_NE(dynamic_cast<Druid*>(restored.get()), nullptr);
+}
+
+TEST(NpcRecordTest, TagDispatchVisitsEveryKind) {
+    std::vector<std::unique_ptr<Npc>> npcs;
+    npcs.push_back(NpcFactory::createNpc("Dragon", "A", 0, 0));
+    npcs.push_back(NpcFactory::createNpc("Elf", "B", 0, 0));
+    npcs.push_back(NpcFactory::createNpc("Elf", "C", 0, 0));
+    npcs.push_back(NpcFactory::createNpc("Druid", "D", 0, 0));
+    std::vector<NpcRecord> records = toRecords(npcs);
+    records.push_back({NpcKind::Unknown, 1, 1, "Stranger"});
+
+    KindCounter counter;
+    counter.visit(records);
+    EXPECT_EQ(counter.dragons, 1);
+    EXPECT_EQ(counter.elves, 2);
+    EXPECT_EQ(counter.druids, 1);
+    EXPECT_EQ(counter.others, 1);
+}
+
+TEST(NpcRecordTest, VisitorAdapterKeepsExistingVisitors) {
+    NpcRecord elf{NpcKind::Elf, 10, 20, "Legolas"};
+    NpcRecord dragon{NpcKind::Dragon, 5, 5, "Smaug"};
+    ElfMover mover;
+    acceptRecord(elf, mover);
+    acceptRecord(dragon, mover);
+    EXPECT_EQ(mover.visited, 2);
+    EXPECT_EQ(elf.x, 11);
+    EXPECT_EQ(dragon.x, 5);
+
+    NpcRecord stranger{NpcKind::Unknown, 0, 0, "Stranger"};
+    EXPECT_THROW(acceptRecord(stranger, mover), std::logic_error);
+}
+
+TEST(NpcRecordTest, DistanceMatchesNpc) {
+    auto a = NpcFactory::createNpc("Dragon", "A", 3, 0);
+    auto b = NpcFactory::createNpc("Elf", "B", 0, 4);
+    EXPECT_DOUBLE_EQ(NpcRecord::fromNpc(*a).distanceTo(NpcRecord::fromNpc(*b)), a->distanceTo(*b));
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include "../include/npc_registry.h"
+#include "../include/factory.h"
+#include "../include/combat_visitor.h"
+#include "../include/arena.h"
+#include "../include/visitor.h"
+#include <memory>
+
+// Вид, подключаемый без правок фабрики, CombatVisitor и Visitor
+namespace {
+
+class Goblin : public Npc {
+    public:
+        Goblin(int x, int y, const std::string& name) : Npc(x, y, "Goblin", name) {}
+
+        void accept(Visitor& visitor) override {
+            visitor.visit(static_cast<Npc&>(*this));
+        }
+};
+
+std::unique_ptr<Npc> createGoblin(int x, int y, const std::string& name) {
+    return std::make_unique<Goblin>(x, y, name);
+}
+
+NpcRegistrar goblinRegistrar("Goblin", &createGoblin, {"Dragon"});
+
+}
+
+TEST(NpcRegistryTest, BuiltinKindsKeepFixedIds) {
+    NpcRegistry& registry = NpcRegistry::instance();
+    ASSERT_NE(registry.find("Dragon"), nullptr);
+    EXPECT_EQ(registry.find("Dragon")->kind, NpcKind::Dragon);
+    EXPECT_EQ(registry.find("Elf")->kind, NpcKind::Elf);
+    EXPECT_EQ(registry.find("Druid")->kind, NpcKind::Druid);
+    EXPECT_EQ(registry.find("Orc"), nullptr);
+    EXPECT_EQ(registry.find(""), nullptr);
+    EXPECT_STREQ(kindName(NpcKind::Elf), "Elf");
+}
+
+TEST(NpcRegistryTest, BuiltinRules) {
+    NpcRegistry& registry = NpcRegistry::instance();
+    EXPECT_TRUE(registry.canKill(NpcKind::Dragon, NpcKind::Elf));
+    EXPECT_TRUE(registry.canKill(NpcKind::Elf, NpcKind::Druid));
+    EXPECT_TRUE(registry.canKill(NpcKind::Druid, NpcKind::Dragon));
+    EXPECT_FALSE(registry.canKill(NpcKind::Elf, NpcKind::Dragon));
+    EXPECT_FALSE(registry.canKill(NpcKind::Dragon, NpcKind::Dragon));
+}
+
+TEST(NpcRegistryTest, OutcomeTableMatchesRules) {
+    NpcRegistry& registry = NpcRegistry::instance();
+    EXPECT_EQ(registry.outcome(NpcKind::Dragon, NpcKind::Elf), PairOutcome::FirstKills);
+    EXPECT_EQ(registry.outcome(NpcKind::Elf, NpcKind::Dragon), PairOutcome::SecondKills);
+    EXPECT_EQ(registry.outcome(NpcKind::Druid, NpcKind::Druid), PairOutcome::None);
+    EXPECT_EQ(registry.outcome(NpcKind::Unknown, NpcKind::Elf), PairOutcome::None);
+
+    for (size_t a = 0; a < kNpcKindCount; ++a) {
+        for (size_t b = 0; b < kNpcKindCount; ++b) {
+            auto first = static_cast<NpcKind>(a);
+            auto second = static_cast<NpcKind>(b);
+            auto bits = static_cast<unsigned>(registry.outcome(first, second));
+            EXPECT_EQ((bits & 1) != 0, registry.canKill(first, second));
+            EXPECT_EQ((bits & 2) != 0, registry.canKill(second, first));
+        }
+    }
+}
+
+TEST(NpcRegistryTest, PluginKindRegisteredAtStaticInit) {
+    const NpcKindInfo* goblin = NpcRegistry::instance().find("Goblin");
+    ASSERT_NE(goblin, nullptr);
+    EXPECT_EQ(static_cast<int>(goblin->kind), 3);
+
+    auto npc = NpcFactory::createFromString("Goblin Snaga 10 20");
+    EXPECT_EQ(npc->getType(), "Goblin");
+    EXPECT_EQ(npc->getKind(), goblin->kind);
+}
+
+TEST(NpcRegistryTest, PluginKindFightsByRegisteredRules) {
+    CombatVisitor visitor;
+    auto goblin = NpcFactory::createNpc("Goblin", "Snaga", 0, 0);
+    auto dragon = NpcFactory::createNpc("Dragon", "Smaug", 1, 1);
+    auto elf = NpcFactory::createNpc("Elf", "Legolas", 2, 2);
+
+    EXPECT_TRUE(visitor.canKill(goblin.get(), dragon.get()));
+    EXPECT_FALSE(visitor.canKill(dragon.get(), goblin.get()));
+    EXPECT_FALSE(visitor.canKill(goblin.get(), elf.get()));
+
+    Arena arena;
+    arena.addNpc(std::move(goblin));
+    arena.addNpc(std::move(dragon));
+    arena.startBattle(10.0);
+    EXPECT_EQ(arena.getNpcCount(), 1u);
+}
+
+TEST(NpcRegistryTest, DuplicateRegistrationRejected) {
+    EXPECT_THROW(NpcRegistry::instance().registerKind("Goblin", &createGoblin), std::invalid_argument);
+}
+
+TEST(NpcRegistryTest, LookupsSurviveLaterRegistration) {
+    NpcRegistry& registry = NpcRegistry::instance();
+    const NpcKindInfo* dragon = registry.info(NpcKind::Dragon);
+    const NpcKindInfo* goblin = registry.find("Goblin");
+    const char* dragonName = dragon->type.c_str();
+
+    registry.registerKind("Troll", &createGoblin, {"Goblin"});
+
+    EXPECT_EQ(registry.info(NpcKind::Dragon), dragon);
+    EXPECT_EQ(registry.find("Goblin"), goblin);
+    EXPECT_STREQ(dragonName, "Dragon");
+    EXPECT_TRUE(registry.canKill(registry.find("Troll")->kind, goblin->kind));
+}
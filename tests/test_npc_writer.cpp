@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "../include/npc_writer.h"
+#include "../include/arena.h"
+#include "../include/factory.h"
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+// Приёмник, запоминающий размеры блоков
+class RecordingSink : public TextSink {
+    public:
+        std::string text;
+        std::vector<std::size_t> blocks;
+
+        void write(const char* data, std::size_t size) override {
+            text.append(data, size);
+            blocks.push_back(size);
+        }
+};
+
+}
+
+TEST(NpcWriterTest, RecordAndInfoMatchStreamFormats) {
+    auto npc = NpcFactory::createNpc("Elf", "Legolas", 7, 450);
+    RecordingSink sink;
+    {
+        NpcTextWriter writer(sink);
+        writer.writeRecord(*npc);
+        writer.writeInfo(*npc);
+    }
+
+    std::ostringstream expected;
+    expected << "Elf Legolas 7 450\n" << *npc;
+    EXPECT_EQ(sink.text, expected.str());
+}
+
+TEST(NpcWriterTest, FlushesInBlocks) {
+    RecordingSink sink;
+    NpcTextWriter writer(sink, 256);
+    for (int i = 0; i < 1000; ++i) {
+        writer.append(i);
+        writer.append(' ');
+    }
+    writer.append(std::numeric_limits<int>::min());
+    writer.flush();
+
+    EXPECT_GT(sink.blocks.size(), 1u);
+    for (std::size_t size : sink.blocks) {
+        EXPECT_LE(size, 256u);
+    }
+    EXPECT_EQ(sink.text.substr(0, 8), "0 1 2 3 ");
+    EXPECT_EQ(sink.text.substr(sink.text.size() - 11), "-2147483648");
+}
+
+TEST(NpcWriterTest, LongTextBypassesBuffer) {
+    RecordingSink sink;
+    NpcTextWriter writer(sink, 256);
+    writer.append('x');
+    writer.append(std::string(1000, 'y'));
+    writer.flush();
+    ASSERT_EQ(sink.blocks.size(), 2u);
+    EXPECT_EQ(sink.blocks[1], 1000u);
+    EXPECT_EQ(sink.text.size(), 1001u);
+}
+
+TEST(NpcWriterTest, SaveToFileRoundTrip) {
+    const std::string filename = "test_npc_writer_save.txt";
+    Arena arena;
+    arena.createAndAddNpc("Dragon", "Smaug", 0, 500);
+    arena.createAndAddNpc("Druid", "Malfurion", 123, 45);
+
+    EXPECT_EQ(arena.saveToFile(filename).saved, 2u);
+    std::ifstream file(filename);
+    std::stringstream content;
+    content << file.rdbuf();
+    // Порядок имён: Malfurion, Smaug
+    EXPECT_EQ(content.str(), "Druid Malfurion 123 45\nDragon Smaug 0 500\n");
+
+    Arena loaded;
+    EXPECT_EQ(loaded.loadFromFile(filename).loaded, 2u);
+    std::remove(filename.c_str());
+}
+
+TEST(NpcWriterTest, OpenFailureThrows) {
+    EXPECT_THROW(FileSink("/nonexistent_dir/file.txt"), std::runtime_error);
+    Arena arena;
+    EXPECT_THROW(arena.saveToFile("/nonexistent_dir/file.txt"), std::runtime_error);
+}
@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+#include "../include/region_arena.h"
+#include "../include/arena.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::string kRegionFile = "test_regions.bin";
+const std::string kSavedFile = "test_regions_saved.bin";
+
+const char* const kTypes[] = {"Dragon", "Elf", "Druid"};
+
+// Арена 200x200 с NPC, разбросанными по всем регионам 16x16
+Arena makeWorld(size_t count) {
+    Arena arena(200, 200);
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> coord(0, 200);
+    for (size_t i = 0; i < count; ++i) {
+        arena.createAndAddNpc(kTypes[i % 3], "Npc" + std::to_string(i), coord(rng), coord(rng));
+    }
+    return arena;
+}
+
+std::vector<std::string> namesInArea(const Arena& arena, const RegionRect& area) {
+    std::vector<std::string> names;
+    arena.forEachNpc([&](const Npc& npc) {
+        if (area.contains(npc.getX(), npc.getY())) {
+            names.push_back(npc.getName());
+        }
+    });
+    return names;
+}
+
+std::vector<std::string> namesInArea(RegionArena& arena, const RegionRect& area) {
+    std::vector<std::string> names;
+    arena.forEachNpcInArea(area, [&](const NpcRecord& npc) { names.push_back(npc.name); });
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+}
+
+TEST(RegionArenaTest, OpenReadsOnlyIndex) {
+    Arena world = makeWorld(2000);
+    EXPECT_EQ(RegionArena::save(world, kRegionFile, 16), 2000u);
+
+    RegionArena arena(kRegionFile);
+    EXPECT_EQ(arena.getRegionCount(), 13u * 13u);
+    EXPECT_EQ(arena.getNpcCount(), 2000u);
+    EXPECT_EQ(arena.getRegionLoads(), 0u);
+    EXPECT_EQ(arena.getResidentRegionCount(), 0u);
+
+    std::remove(kRegionFile.c_str());
+}
+
+TEST(RegionArenaTest, QueryLoadsTouchedRegions) {
+    Arena world = makeWorld(2000);
+    RegionArena::save(world, kRegionFile, 16);
+    RegionArena arena(kRegionFile);
+
+    RegionRect inside{20, 20, 30, 30};
+    EXPECT_EQ(namesInArea(arena, inside), namesInArea(world, inside));
+    EXPECT_EQ(arena.getRegionLoads(), 1u);
+
+    // Область на стыке четырёх регионов, включая границу арены
+    RegionRect corner{180, 180, 200, 200};
+    EXPECT_EQ(namesInArea(arena, corner), namesInArea(world, corner));
+    EXPECT_EQ(arena.getRegionLoads(), 5u);
+
+    std::remove(kRegionFile.c_str());
+}
+
+TEST(RegionArenaTest, LeastRecentlyUsedRegionsEvicted) {
+    Arena world = makeWorld(500);
+    RegionArena::save(world, kRegionFile, 16);
+    RegionArena arena(kRegionFile, 2);
+    auto touch = [&arena](int x, int y) {
+        arena.forEachNpcInArea({x, y, x, y}, [](const NpcRecord&) {});
+    };
+
+    touch(0, 0);
+    touch(20, 0);
+    touch(0, 0);
+    touch(40, 0);
+    EXPECT_EQ(arena.getResidentRegionCount(), 2u);
+    EXPECT_EQ(arena.getRegionLoads(), 3u);
+
+    // (20, 0) использовался давнее всех и был выгружен, (0, 0) - нет
+    touch(0, 0);
+    EXPECT_EQ(arena.getRegionLoads(), 3u);
+    touch(20, 0);
+    EXPECT_EQ(arena.getRegionLoads(), 4u);
+
+    std::remove(kRegionFile.c_str());
+}
+
+TEST(RegionArenaTest, BattleMatchesArenaOverArea) {
+    Arena world = makeWorld(3000);
+    RegionArena::save(world, kRegionFile, 16);
+    RegionArena arena(kRegionFile);
+
+    RegionRect area{10, 10, 60, 45};
+    Arena reference(200, 200);
+    world.forEachNpc([&](const Npc& npc) {
+        if (area.contains(npc.getX(), npc.getY())) {
+            reference.createAndAddNpc(npc.getType(), npc.getName(), npc.getX(), npc.getY());
+        }
+    });
+    BattleResult expected = reference.startBattle(4);
+    BattleResult result = arena.startBattle(4, area);
+
+    EXPECT_EQ(result.fights, expected.fights);
+    EXPECT_EQ(result.killed, expected.killed);
+    EXPECT_FALSE(result.killed.empty());
+    EXPECT_EQ(arena.getNpcCount(), 3000u - result.killed.size());
+    EXPECT_EQ(namesInArea(arena, area), namesInArea(reference, area));
+
+    std::remove(kRegionFile.c_str());
+}
+
+TEST(RegionArenaTest, ChangedRegionsKeptUntilSaved) {
+    Arena world = makeWorld(3000);
+    RegionArena::save(world, kRegionFile, 16);
+    RegionArena arena(kRegionFile, 1);
+
+    RegionRect area{0, 0, 15, 15};
+    BattleResult result = arena.startBattle(5, area);
+    ASSERT_FALSE(result.killed.empty());
+    size_t survivors = namesInArea(arena, area).size();
+
+    // При превышении предела выгружается неизменённый регион, а не изменённый
+    arena.forEachNpcInArea({100, 100, 100, 100}, [](const NpcRecord&) {});
+    EXPECT_EQ(arena.getResidentRegionCount(), 1u);
+    size_t loads = arena.getRegionLoads();
+    EXPECT_EQ(namesInArea(arena, area).size(), survivors);
+    EXPECT_EQ(arena.getRegionLoads(), loads);
+
+    EXPECT_THROW(arena.saveToFile(kRegionFile), std::invalid_argument);
+    EXPECT_EQ(arena.saveToFile(kSavedFile), 3000u - result.killed.size());
+    EXPECT_EQ(arena.getResidentRegionCount(), 1u);
+    std::remove(kRegionFile.c_str());
+
+    RegionArena reopened(kSavedFile);
+    EXPECT_EQ(reopened.getNpcCount(), 3000u - result.killed.size());
+    EXPECT_EQ(namesInArea(reopened, area).size(), survivors);
+    EXPECT_EQ(namesInArea(reopened, {100, 100, 150, 150}), namesInArea(world, {100, 100, 150, 150}));
+
+    std::remove(kSavedFile.c_str());
+}
+
+TEST(RegionArenaTest, RejectsOtherFiles) {
+    EXPECT_THROW(RegionArena("no_such_regions.bin"), std::runtime_error);
+    Arena world = makeWorld(10);
+    world.saveToFile(kRegionFile);
+    EXPECT_THROW(RegionArena arena(kRegionFile), std::runtime_error);
+    EXPECT_THROW(RegionArena::save(world, kRegionFile, 0), std::invalid_argument);
+    std::remove(kRegionFile.c_str());
+}
+
+TEST(RegionArenaTest, RejectsInconsistentHeader) {
+    Arena world = makeWorld(100);
+    RegionArena::save(world, kRegionFile, 16);
+    std::string original;
+    {
+        std::ifstream file(kRegionFile, std::ios::binary);
+        original.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    // Каждая порча записывается в целую копию файла
+    auto corrupt = [&](size_t offset, std::uint32_t value) {
+        std::string broken = original;
+        std::memcpy(broken.data() + offset, &value, sizeof(value));
+        std::ofstream file(kRegionFile, std::ios::binary | std::ios::trunc);
+        file.write(broken.data(), static_cast<std::streamsize>(broken.size()));
+    };
+
+    corrupt(offsetof(RegionFileHeader, regionSize), 0);
+    EXPECT_THROW(RegionArena arena(kRegionFile), std::runtime_error);
+    corrupt(offsetof(RegionFileHeader, cols), 0);
+    EXPECT_THROW(RegionArena arena(kRegionFile), std::runtime_error);
+    corrupt(offsetof(RegionFileHeader, rows), 100000);
+    EXPECT_THROW(RegionArena arena(kRegionFile), std::runtime_error);
+    corrupt(offsetof(RegionFileHeader, width), 0x7FFFFFF0u);
+    EXPECT_THROW(RegionArena arena(kRegionFile), std::runtime_error);
+    // Длина первого типа сразу за заголовком
+    corrupt(sizeof(RegionFileHeader), 0xFFFFFFF0u);
+    EXPECT_THROW(RegionArena arena(kRegionFile), std::runtime_error);
+
+    corrupt(offsetof(RegionFileHeader, regionSize), 16);
+    RegionArena arena(kRegionFile);
+    EXPECT_EQ(arena.getNpcCount(), 100u);
+    std::remove(kRegionFile.c_str());
+}
+
+TEST(RegionArenaTest, EvictionSkipsChangedRegions) {
+    Arena world = makeWorld(3000);
+    RegionArena::save(world, kRegionFile, 16);
+    RegionArena arena(kRegionFile, 2);
+    auto touch = [&arena](int x, int y) {
+        arena.forEachNpcInArea({x, y, x, y}, [](const NpcRecord&) {});
+    };
+
+    // Бой меняет регион (0, 0), и он остаётся загруженным при любом обходе
+    RegionRect area{0, 0, 15, 15};
+    ASSERT_FALSE(arena.startBattle(100, area).killed.empty());
+    for (int x = 16; x < 200; x += 16) {
+        touch(x, 100);
+    }
+    EXPECT_EQ(arena.getResidentRegionCount(), 2u);
+    size_t loads = arena.getRegionLoads();
+    touch(0, 0);
+    EXPECT_EQ(arena.getRegionLoads(), loads);
+
+    // После сохранения регион снова в очереди и вытесняется
+    arena.saveToFile(kSavedFile);
+    touch(16, 16);
+    touch(32, 16);
+    touch(0, 0);
+    EXPECT_EQ(arena.getRegionLoads(), loads + 3);
+
+    std::remove(kRegionFile.c_str());
+    std::remove(kSavedFile.c_str());
+}
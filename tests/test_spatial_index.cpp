@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include "../include/spatial_index.h"
+#include "../include/arena.h"
+#include "../include/factory.h"
+#include <random>
+#include <vector>
+
+namespace {
+
+std::vector<SpatialPoint> uniformPoints(std::size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> coord(0, 500);
+    std::vector<SpatialPoint> points;
+    for (std::size_t i = 0; i < count; ++i) {
+        points.push_back({coord(rng), coord(rng), i});
+    }
+    return points;
+}
+
+// Несколько плотных "комнат босса" на пустой карте
+std::vector<SpatialPoint> clusteredPoints(std::size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> center(20, 480);
+    std::uniform_int_distribution<int> offset(-10, 10);
+    std::vector<std::pair<int, int>> rooms;
+    for (int i = 0; i < 4; ++i) {
+        rooms.push_back({center(rng), center(rng)});
+    }
+    std::vector<SpatialPoint> points;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& room = rooms[i % rooms.size()];
+        points.push_back({room.first + offset(rng), room.second + offset(rng), i});
+    }
+    return points;
+}
+
+void expectSamePairs(const std::vector<SpatialPoint>& points, double range) {
+    std::vector<CandidatePair> expected;
+    collectPairsWithin(SpatialBackend::BruteForce, points, range, expected);
+
+    for (auto backend : {SpatialBackend::UniformGrid, SpatialBackend::KdTree, SpatialBackend::Auto}) {
+        std::vector<CandidatePair> actual;
+        collectPairsWithin(backend, points, range, actual);
+        ASSERT_EQ(actual.size(), expected.size()) << spatialBackendName(backend);
+        for (std::size_t i = 0; i < actual.size(); ++i) {
+            EXPECT_EQ(actual[i].first, expected[i].first);
+            EXPECT_EQ(actual[i].second, expected[i].second);
+        }
+    }
+}
+
+}
+
+TEST(SpatialIndexTest, WithinRangeMatchesDistance) {
+    EXPECT_TRUE(withinRange(3, 4, 5.0));
+    EXPECT_FALSE(withinRange(3, 4, 4.99));
+    EXPECT_TRUE(withinRange(0, 0, 0.0));
+}
+
+TEST(SpatialIndexTest, UniformPointsAllBackendsAgree) {
+    auto points = uniformPoints(600, 1);
+    for (double range : {0.0, 5.0, 17.5, 60.0, 800.0}) {
+        expectSamePairs(points, range);
+    }
+}
+
+TEST(SpatialIndexTest, ClusteredPointsAllBackendsAgree) {
+    auto points = clusteredPoints(600, 2);
+    for (double range : {0.0, 3.0, 12.0, 100.0}) {
+        expectSamePairs(points, range);
+    }
+}
+
+TEST(SpatialIndexTest, EmptyAndSinglePoint) {
+    std::vector<SpatialPoint> none;
+    std::vector<CandidatePair> pairs;
+    collectPairsWithin(SpatialBackend::KdTree, none, 10.0, pairs);
+    EXPECT_TRUE(pairs.empty());
+
+    std::vector<SpatialPoint> one = {{10, 10, 0}};
+    collectPairsWithin(SpatialBackend::UniformGrid, one, 10.0, pairs);
+    EXPECT_TRUE(pairs.empty());
+}
+
+TEST(SpatialIndexTest, AutoChoosesByDistribution) {
+    EXPECT_EQ(chooseSpatialBackend(uniformPoints(10, 3), 20.0), SpatialBackend::BruteForce);
+    EXPECT_EQ(chooseSpatialBackend(uniformPoints(2000, 4), 20.0), SpatialBackend::UniformGrid);
+    EXPECT_EQ(chooseSpatialBackend(clusteredPoints(2000, 5), 5.0), SpatialBackend::KdTree);
+}
+
+TEST(SpatialIndexTest, KdTreeBuildsBalancedTree) {
+    KdTree tree;
+    tree.build(uniformPoints(1000, 6));
+    EXPECT_GT(tree.getNodeCount(), 1u);
+    EXPECT_LT(tree.getNodeCount(), 1000u);
+}
+
+TEST(SpatialIndexTest, KindFilterSkipsPairsBeforeDistance) {
+    auto points = clusteredPoints(600, 8);
+    for (auto& p : points) {
+        p.kind = static_cast<std::uint8_t>(p.index % 3);
+    }
+    // Пары только разных видов
+    KindPairFilter filter;
+    for (size_t a = 0; a < 3; ++a) {
+        for (size_t b = 0; b < 3; ++b) {
+            filter.allowed[a][b] = a != b;
+        }
+    }
+
+    std::vector<CandidatePair> all;
+    PairSearchInfo unfiltered = collectPairsWithin(SpatialBackend::BruteForce, points, 8.0, all);
+    std::vector<CandidatePair> expected;
+    for (const auto& pair : all) {
+        if (pair.first % 3 != pair.second % 3) expected.push_back(pair);
+    }
+
+    for (auto backend : {SpatialBackend::BruteForce, SpatialBackend::UniformGrid, SpatialBackend::KdTree}) {
+        std::vector<CandidatePair> actual;
+        PairSearchInfo info = collectPairsWithin(backend, points, 8.0, actual, &filter);
+        ASSERT_EQ(actual.size(), expected.size()) << spatialBackendName(backend);
+        for (std::size_t i = 0; i < actual.size(); ++i) {
+            EXPECT_EQ(actual[i].first, expected[i].first);
+            EXPECT_EQ(actual[i].second, expected[i].second);
+        }
+        if (backend == SpatialBackend::BruteForce) {
+            EXPECT_LT(info.distanceChecks, unfiltered.distanceChecks);
+        }
+    }
+}
+
+TEST(SpatialIndexTest, PartitionedIndexMatchesFilteredSearch) {
+    auto points = uniformPoints(900, 9);
+    auto clustered = clusteredPoints(900, 10);
+    points.insert(points.end(), clustered.begin(), clustered.end());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        points[i].index = i;
+        // Преобладающий вид и два редких
+        points[i].kind = static_cast<std::uint8_t>(i % 10 == 0 ? 1 : (i % 10 == 1 ? 2 : 0));
+    }
+    // Цикл из трёх видов и вид 2, враждебный сам себе
+    KindPairFilter filter;
+    filter.allowed[0][1] = filter.allowed[1][2] = filter.allowed[2][0] = true;
+    filter.allowed[2][2] = true;
+
+    for (double range : {0.0, 4.0, 25.0, 700.0}) {
+        std::vector<CandidatePair> expected;
+        collectPairsWithin(SpatialBackend::BruteForce, points, range, expected, &filter);
+
+        for (auto backend : {SpatialBackend::BruteForce, SpatialBackend::UniformGrid,
+                             SpatialBackend::KdTree, SpatialBackend::Auto}) {
+            KindPartitionedIndex index;
+            index.build(backend, points, range);
+            std::vector<CandidatePair> actual;
+            index.collectPairsWithin(range, filter, actual);
+            ASSERT_EQ(actual.size(), expected.size()) << spatialBackendName(backend) << " " << range;
+            for (std::size_t i = 0; i < actual.size(); ++i) {
+                EXPECT_EQ(actual[i].first, expected[i].first);
+                EXPECT_EQ(actual[i].second, expected[i].second);
+            }
+        }
+    }
+}
+
+TEST(SpatialIndexTest, PartitionedIndexSkipsSameKindPairs) {
+    std::vector<SpatialPoint> points;
+    for (std::size_t i = 0; i < 200; ++i) {
+        points.push_back({static_cast<int>(i % 20), static_cast<int>(i / 20), i, 0});
+    }
+    points.push_back({5, 5, 200, 1});
+
+    KindPairFilter filter;
+    filter.allowed[0][1] = true;
+    KindPartitionedIndex index;
+    index.build(SpatialBackend::BruteForce, points, 100.0);
+    EXPECT_EQ(index.getPartitionSize(NpcKind::Dragon), 200u);
+    EXPECT_EQ(index.getPartitionSize(NpcKind::Elf), 1u);
+
+    std::vector<CandidatePair> pairs;
+    PairSearchInfo info = index.collectPairsWithin(100.0, filter, pairs);
+    EXPECT_EQ(info.distanceChecks, 200u);
+    EXPECT_EQ(pairs.size(), 200u);
+}
+
+TEST(SpatialIndexTest, GridCrossQueriesOutsideBounds) {
+    std::vector<SpatialPoint> inside = {{100, 100, 0}, {110, 100, 1}};
+    std::vector<SpatialPoint> queries = {{95, 100, 2}, {-50, -50, 3}, {120, 100, 4}};
+    UniformGrid grid;
+    grid.build(inside, 10.0);
+    std::vector<CandidatePair> pairs;
+    grid.collectCrossPairs(queries, 10.0, pairs);
+    ASSERT_EQ(pairs.size(), 2u);
+}
+
+TEST(SpatialIndexTest, ArenaBattleSameForAllBackends) {
+    const char* types[] = {"Dragon", "Elf", "Druid"};
+    auto points = clusteredPoints(300, 7);
+
+    std::vector<size_t> survivors;
+    for (auto backend : {SpatialBackend::BruteForce, SpatialBackend::UniformGrid,
+                         SpatialBackend::KdTree, SpatialBackend::Auto}) {
+        Arena arena;
+        arena.setSpatialBackend(backend);
+        for (const auto& p : points) {
+            arena.createAndAddNpc(types[p.index % 3], "Npc" + std::to_string(p.index), p.x, p.y);
+        }
+        arena.startBattle(6.0);
+        survivors.push_back(arena.getNpcCount());
+    }
+
+    for (size_t count : survivors) {
+        EXPECT_EQ(count, survivors.front());
+    }
+    EXPECT_LT(survivors.front(), points.size());
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "../include/stream_battle.h"
+#include "../include/arena.h"
+#include "../include/factory.h"
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Line {
+    std::string type;
+    std::string name;
+    int x;
+    int y;
+};
+
+std::vector<Line> randomSortedLines(size_t count, unsigned seed) {
+    static const char* kTypes[] = {"Dragon", "Elf", "Druid"};
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> coord(0, 500);
+    std::vector<Line> lines;
+    for (size_t i = 0; i < count; ++i) {
+        lines.push_back({kTypes[i % 3], "Npc" + std::to_string(i), coord(rng), coord(rng)});
+    }
+    std::sort(lines.begin(), lines.end(), [](const Line& a, const Line& b) { return a.x < b.x; });
+    return lines;
+}
+
+void writeLines(const std::string& filename, const std::vector<Line>& lines) {
+    std::ofstream out(filename);
+    for (const auto& line : lines) {
+        out << line.type << " " << line.name << " " << line.x << " " << line.y << "\n";
+    }
+}
+
+std::set<std::string> readNames(const std::string& filename) {
+    std::set<std::string> names;
+    std::ifstream in(filename);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty()) {
+            names.insert(NpcFactory::createFromString(line)->getName());
+        }
+    }
+    return names;
+}
+
+}
+
+TEST(StreamBattleTest, MatchesArenaBattle) {
+    auto lines = randomSortedLines(800, 11);
+    writeLines("stream_input.txt", lines);
+
+    for (double range : {0.0, 7.0, 25.0, 120.0}) {
+        Arena arena;
+        for (const auto& line : lines) {
+            arena.createAndAddNpc(line.type, line.name, line.x, line.y);
+        }
+        BattleResult expected = arena.startBattle(range);
+
+        StreamBattle battle(range);
+        StreamBattleResult result = battle.run("stream_input.txt", "stream_output.txt");
+
+        EXPECT_EQ(result.read, lines.size());
+        EXPECT_EQ(result.fights, expected.fights) << "range " << range;
+        EXPECT_EQ(result.written, expected.npcsAfter) << "range " << range;
+
+        std::set<std::string> survivors;
+        arena.forEachNpc([&survivors](const Npc& npc) { survivors.insert(npc.getName()); });
+        EXPECT_EQ(readNames("stream_output.txt"), survivors);
+    }
+
+    std::remove("stream_input.txt");
+    std::remove("stream_output.txt");
+}
+
+TEST(StreamBattleTest, ResidentSetBoundedByStrips) {
+    auto lines = randomSortedLines(2000, 12);
+    writeLines("stream_input.txt", lines);
+
+    StreamBattle battle(5.0, 10.0);
+    StreamBattleResult result = battle.run("stream_input.txt", "stream_output.txt");
+
+    EXPECT_DOUBLE_EQ(battle.getStripWidth(), 10.0);
+    EXPECT_EQ(result.read, 2000u);
+    // Две полосы по 10 м из 500 - порядка 4% NPC
+    EXPECT_LT(result.peakResident, 200u);
+
+    std::remove("stream_input.txt");
+    std::remove("stream_output.txt");
+}
+
+TEST(StreamBattleTest, StripNotNarrowerThanRange) {
+    StreamBattle battle(50.0, 10.0);
+    EXPECT_DOUBLE_EQ(battle.getStripWidth(), 50.0);
+    EXPECT_THROW(StreamBattle(-1.0), std::invalid_argument);
+}
+
+TEST(StreamBattleTest, RejectsUnsortedInputAndSkipsBadLines) {
+    std::ofstream out("stream_input.txt");
+    out << "Dragon Smaug 100 100\n";
+    out << "garbage\n";
+    out << "Elf Legolas 50 50\n";
+    out.close();
+
+    StreamBattle battle(10.0);
+    EXPECT_THROW(battle.run("stream_input.txt", "stream_output.txt"), std::runtime_error);
+    EXPECT_THROW(battle.run("no_such_stream_file.txt", "stream_output.txt"), std::runtime_error);
+
+    std::remove("stream_input.txt");
+    std::remove("stream_output.txt");
+}
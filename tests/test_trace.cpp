@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "../include/trace.h"
+#include "../include/arena.h"
+#include "../include/thread_pool.h"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+class SilentObserver : public Observer {
+    public:
+        void notify(const std::string&) override {}
+};
+
+size_t countOccurrences(const std::string& text, const std::string& pattern) {
+    size_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+std::string traceJson() {
+    std::ostringstream os;
+    Tracer::instance().writeJson(os);
+    return os.str();
+}
+
+}
+
+TEST(TraceTest, NothingRecordedWhileStopped) {
+    Tracer::instance().start();
+    Tracer::instance().stop();
+    {
+        TraceSpan span("idle", "test");
+    }
+    EXPECT_EQ(Tracer::instance().getEventCount(), 0u);
+}
+
+TEST(TraceTest, BattleSpansNestInsideBattle) {
+    if (!ARENA_ENABLE_TRACING) GTEST_SKIP() << "tracing disabled at build time";
+
+    Arena arena;
+    arena.addObserver(std::make_shared<SilentObserver>());
+    for (int i = 0; i < 50; ++i) {
+        arena.createAndAddNpc(i % 2 ? "Elf" : "Dragon", "Npc" + std::to_string(i), i * 2, 0);
+    }
+
+    Tracer::instance().start();
+    arena.startBattle(3);
+    arena.saveToFile("test_trace_save.txt");
+    Arena loaded;
+    loaded.loadFromFile("test_trace_save.txt");
+    Tracer::instance().stop();
+    std::remove("test_trace_save.txt");
+
+    std::string json = traceJson();
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(json.find("\"name\":\"Arena::startBattle\",\"cat\":\"battle\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"npcs\":50}"), std::string::npos);
+    for (const char* phase : {"candidates", "combat", "dispatch", "removal", "observers",
+                              "Arena::saveToFile", "Arena::loadFromFile"}) {
+        EXPECT_NE(json.find(std::string("\"name\":\"") + phase + "\""), std::string::npos) << phase;
+    }
+    EXPECT_EQ(Tracer::instance().getEventCount(), 8u);
+}
+
+TEST(TraceTest, WorkerThreadsGetOwnTimelines) {
+    if (!ARENA_ENABLE_TRACING) GTEST_SKIP() << "tracing disabled at build time";
+
+    Tracer::instance().start();
+    {
+        ThreadPool pool(2);
+        // Две задачи ждут друг друга, поэтому отрезки есть у обоих рабочих потоков
+        std::atomic<int> started{0};
+        for (int i = 0; i < 2; ++i) {
+            pool.submit([&started] {
+                TraceSpan span("work", "test");
+                started.fetch_add(1);
+                while (started.load() < 2) {
+                    std::this_thread::yield();
+                }
+            });
+        }
+        for (int i = 0; i < 18; ++i) {
+            pool.submit([] { TraceSpan span("work", "test"); });
+        }
+        pool.waitIdle();
+    }
+    Tracer::instance().stop();
+
+    std::string json = traceJson();
+    EXPECT_EQ(countOccurrences(json, "\"name\":\"task\""), 20u);
+    EXPECT_EQ(countOccurrences(json, "\"name\":\"work\""), 20u);
+    EXPECT_NE(json.find("\"args\":{\"name\":\"worker 0\"}"), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"name\":\"worker 1\"}"), std::string::npos);
+}
+
+TEST(TraceTest, RestartClearsAndSaves) {
+    if (!ARENA_ENABLE_TRACING) GTEST_SKIP() << "tracing disabled at build time";
+
+    Tracer::instance().start();
+    Tracer::instance().setThreadName("main \"editor\"");
+    {
+        TraceSpan span("first", "test");
+    }
+    Tracer::instance().start();
+    {
+        TraceSpan span("second", "test");
+        span.setArg("value", -3);
+    }
+    Tracer::instance().stop();
+    EXPECT_EQ(Tracer::instance().getEventCount(), 1u);
+
+    Tracer::instance().saveJson("test_trace.json");
+    std::ifstream file("test_trace.json");
+    std::stringstream content;
+    content << file.rdbuf();
+    file.close();
+    std::remove("test_trace.json");
+
+    EXPECT_EQ(content.str().find("\"first\""), std::string::npos);
+    EXPECT_NE(content.str().find("\"args\":{\"value\":-3}"), std::string::npos);
+    EXPECT_NE(content.str().find("main \\\"editor\\\""), std::string::npos);
+}
+
+TEST(TraceTest, IdleWorkersLeaveNoTimelines) {
+    if (!ARENA_ENABLE_TRACING) GTEST_SKIP() << "tracing disabled at build time";
+
+    // Пулы, отработавшие при выключенной трассировке, буферов не заводят,
+    // а буферы завершившихся потоков отбрасываются при перезапуске
+    Tracer::instance().stop();
+    for (int round = 0; round < 3; ++round) {
+        ThreadPool pool(4);
+        for (int i = 0; i < 8; ++i) {
+            pool.submit([] { TraceSpan span("idle", "test"); });
+        }
+        pool.waitIdle();
+    }
+    Tracer::instance().start();
+    {
+        TraceSpan span("main", "test");
+    }
+    Tracer::instance().stop();
+
+    std::string json = traceJson();
+    EXPECT_EQ(countOccurrences(json, "\"worker "), 0u);
+    EXPECT_EQ(countOccurrences(json, "\"name\":\"thread_name\""), 1u);
+    EXPECT_EQ(Tracer::instance().getEventCount(), 1u);
+}